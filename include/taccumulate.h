@@ -0,0 +1,165 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Способы накопления сумм для скалярного произведения и умножения матриц
+
+#ifndef __TAccumulate_H__
+#define __TAccumulate_H__
+
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+// Политика суммирования
+enum class TSumPolicy
+{
+    naive,     // последовательное сложение
+    pairwise,  // попарное (каскадное) сложение, ошибка O(log n)
+    kahan,     // компенсированное сложение Кэхэна-Ноймайера
+    wide       // накопление в более широком типе
+};
+
+// Тип для накопления в режиме wide
+template<typename T>
+struct TWideType { typedef T type; };
+template<>
+struct TWideType<float> { typedef double type; };
+template<>
+struct TWideType<double> { typedef long double type; };
+
+// Тип, в котором ведутся вычисления: типы хранения пониженной точности
+// (half, bfloat16) расширяются при загрузке, остальные считаются как есть
+template<typename T>
+struct TComputeType { typedef T type; };
+
+// Пакетное преобразование типов, специализируется векторными ядрами
+template<typename From, typename To>
+struct TConvert
+{
+    static void run(const From* src, To* dst, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+            dst[i] = To(src[i]);
+    }
+};
+
+// Политика по умолчанию для операторов TDynamicVector и TDynamicMatrix
+template<typename T>
+struct TSumConfig
+{
+    static TSumPolicy& policy()
+    {
+        static TSumPolicy p = TSumPolicy::naive;
+        return p;
+    }
+};
+
+// Скалярное произведение массивов длины n с выбранной политикой
+template<typename T>
+class TAccumulate
+{
+    static constexpr size_t LANES = 4;
+    static constexpr size_t PAIRWISE_BLOCK = 64;
+
+    static T naive(const T* a, const T* b, size_t n)
+    {
+        T res = T();
+        for (size_t i = 0; i < n; i++)
+            res += a[i] * b[i];
+        return res;
+    }
+
+    // блоки по PAIRWISE_BLOCK суммируются с LANES аккумуляторами
+    static T pairwise(const T* a, const T* b, size_t n)
+    {
+        if (n <= PAIRWISE_BLOCK) {
+            T acc[LANES] = {};
+            size_t i = 0;
+            for (; i + LANES <= n; i += LANES)
+                for (size_t k = 0; k < LANES; k++)
+                    acc[k] += a[i + k] * b[i + k];
+            for (; i < n; i++)
+                acc[0] += a[i] * b[i];
+            return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+        }
+        size_t h = n / 2;
+        return pairwise(a, b, h) + pairwise(a + h, b + h, n - h);
+    }
+
+    // Ноймайер: ошибка округления каждого сложения копится в c
+    static void neumaier(T& s, T& c, T x)
+    {
+        T t = s + x;
+        if (std::abs(s) >= std::abs(x))
+            c += (s - t) + x;
+        else
+            c += (x - t) + s;
+        s = t;
+    }
+    static T kahan(const T* a, const T* b, size_t n)
+    {
+        T s[LANES] = {}, c[LANES] = {};
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES)
+            for (size_t k = 0; k < LANES; k++)
+                neumaier(s[k], c[k], a[i + k] * b[i + k]);
+        for (; i < n; i++)
+            neumaier(s[0], c[0], a[i] * b[i]);
+        T res = T(), comp = T();
+        for (size_t k = 0; k < LANES; k++) {
+            neumaier(res, comp, s[k]);
+            comp += c[k];
+        }
+        return res + comp;
+    }
+
+    // элементы расширяются порциями в буферы на стеке, сумма - в типе вычислений
+    static T widened(const T* a, const T* b, size_t n, TSumPolicy p)
+    {
+        typedef typename TComputeType<T>::type C;
+        const size_t CHUNK = 256;
+        C abuf[CHUNK], bbuf[CHUNK];
+        C res = C();
+        for (size_t i = 0; i < n; i += CHUNK) {
+            size_t m = n - i < CHUNK ? n - i : CHUNK;
+            TConvert<T, C>::run(a + i, abuf, m);
+            TConvert<T, C>::run(b + i, bbuf, m);
+            res += TAccumulate<C>::dot(abuf, bbuf, m, p);
+        }
+        return T(res);
+    }
+
+    static T wide(const T* a, const T* b, size_t n)
+    {
+        typedef typename TWideType<T>::type W;
+        W acc[LANES] = {};
+        size_t i = 0;
+        for (; i + LANES <= n; i += LANES)
+            for (size_t k = 0; k < LANES; k++)
+                acc[k] += W(a[i + k]) * W(b[i + k]);
+        for (; i < n; i++)
+            acc[0] += W(a[i]) * W(b[i]);
+        return T((acc[0] + acc[1]) + (acc[2] + acc[3]));
+    }
+public:
+    static T dot(const T* a, const T* b, size_t n, TSumPolicy p)
+    {
+        // для целых типов все политики точны и совпадают с naive
+        if constexpr (!std::is_same<typename TComputeType<T>::type, T>::value)
+            return widened(a, b, n, p);
+        else if constexpr (!std::is_floating_point<T>::value)
+            return naive(a, b, n);
+        else
+            switch (p) {
+            case TSumPolicy::pairwise:
+                return pairwise(a, b, n);
+            case TSumPolicy::kahan:
+                return kahan(a, b, n);
+            case TSumPolicy::wide:
+                return wide(a, b, n);
+            default:
+                return naive(a, b, n);
+            }
+    }
+};
+
+#endif
@@ -0,0 +1,280 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Асинхронные операции над матрицами: результаты-будущие в пуле потоков
+
+#ifndef __TAsync_H__
+#define __TAsync_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tmatrix.h"
+#include "tparallel.h"
+
+template<typename R> class TFuture;
+
+template<typename F>
+auto async_run(F f) -> TFuture<typename std::decay<decltype(f())>::type>;
+
+// Результат асинхронной операции. Копии разделяют одно состояние, как у
+// std::shared_future: get() возвращает ссылку на общий результат, а then()
+// можно вызывать несколько раз - каждое продолжение получит тот же результат.
+// Продолжения ставятся в пул потоков, когда результат готов, поэтому цепочка
+// операций выполняется без ожидания в вызывающем потоке. Исключение операции
+// передается по цепочке, продолжения при этом не вызываются
+template<typename R>
+class TFuture
+{
+    static_assert(!std::is_void<R>::value, "TFuture requires a result value");
+
+    template<typename U> friend class TFuture;
+    template<typename F>
+    friend auto async_run(F f) -> TFuture<typename std::decay<decltype(f())>::type>;
+    template<typename A, typename B, typename F>
+    friend auto async_join(const TFuture<A>& a, const TFuture<B>& b, F f)
+        -> TFuture<typename std::decay<decltype(f(std::declval<const A&>(), std::declval<const B&>()))>::type>;
+
+    struct TState
+    {
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::atomic<bool> done{ false };
+        std::unique_ptr<R> value;
+        std::exception_ptr error;
+        std::vector<std::function<void()>> next;    // ждут готовности
+    };
+    std::shared_ptr<TState> st;
+
+    explicit TFuture(std::shared_ptr<TState> s) : st(std::move(s)) {}
+
+    static TFuture pending() { return TFuture(std::make_shared<TState>()); }
+
+    // сохраняет результат f() или его исключение и запускает продолжения
+    template<typename F>
+    static void fulfil(const std::shared_ptr<TState>& s, F&& f) noexcept
+    {
+        std::unique_ptr<R> v;
+        std::exception_ptr e;
+        try {
+            v.reset(new R(f()));
+        }
+        catch (...) {
+            e = std::current_exception();
+        }
+        finish(s, std::move(v), e);
+    }
+    static void finish(const std::shared_ptr<TState>& s, std::unique_ptr<R> v, std::exception_ptr e) noexcept
+    {
+        std::vector<std::function<void()>> next;
+        {
+            std::lock_guard<std::mutex> lk(s->mtx);
+            s->value = std::move(v);
+            s->error = e;
+            s->done.store(true, std::memory_order_release);
+            next.swap(s->next);
+        }
+        s->cv.notify_all();
+        for (auto& f : next)
+            f();
+    }
+    // f() вызывается сразу, если результат готов, иначе - потоком, который его вычислит
+    void on_ready(std::function<void()> f) const
+    {
+        {
+            std::lock_guard<std::mutex> lk(st->mtx);
+            if (!st->done.load(std::memory_order_relaxed)) {
+                st->next.push_back(std::move(f));
+                return;
+            }
+        }
+        f();
+    }
+public:
+    TFuture() = default;
+
+    static TFuture ready(R v)
+    {
+        TFuture f = pending();
+        finish(f.st, std::unique_ptr<R>(new R(std::move(v))), nullptr);
+        return f;
+    }
+
+    bool valid() const noexcept { return (bool)st; }
+    bool is_ready() const noexcept { return st && st->done.load(std::memory_order_acquire); }
+
+    // пока результата нет - помогаем пулу, чтобы ожидание из задачи пула не зависло
+    void wait() const
+    {
+        if (!st)
+            throw std::logic_error("Future has no state");
+        while (!st->done.load(std::memory_order_acquire)) {
+            if (TThreadPool::instance().run_pending())
+                continue;
+            std::unique_lock<std::mutex> lk(st->mtx);
+            st->cv.wait_for(lk, std::chrono::microseconds(200),
+                [this]() { return st->done.load(std::memory_order_acquire); });
+        }
+    }
+    const R& get() const
+    {
+        wait();
+        if (st->error)
+            std::rethrow_exception(st->error);
+        return *st->value;
+    }
+
+    // продолжение f(const R&) в пуле потоков после готовности результата
+    template<typename F>
+    auto then(F f) const -> TFuture<typename std::decay<decltype(f(std::declval<const R&>()))>::type>
+    {
+        typedef typename std::decay<decltype(f(std::declval<const R&>()))>::type U;
+        if (!st)
+            throw std::logic_error("Future has no state");
+        TFuture<U> res = TFuture<U>::pending();
+        std::shared_ptr<TState> src = st;
+        std::shared_ptr<typename TFuture<U>::TState> dst = res.st;
+        on_ready([src, dst, f]() {
+            TThreadPool::instance().submit([src, dst, f]() {
+                TMATRIX_TRACE_SCOPE("async");
+                if (src->error)
+                    TFuture<U>::finish(dst, nullptr, src->error);
+                else
+                    TFuture<U>::fulfil(dst, [&]() { return f(*src->value); });
+            });
+        });
+        return res;
+    }
+};
+
+// f() в пуле потоков
+template<typename F>
+auto async_run(F f) -> TFuture<typename std::decay<decltype(f())>::type>
+{
+    typedef typename std::decay<decltype(f())>::type R;
+    TFuture<R> res = TFuture<R>::pending();
+    std::shared_ptr<typename TFuture<R>::TState> dst = res.st;
+    TThreadPool::instance().submit([dst, f]() {
+        TMATRIX_TRACE_SCOPE("async");
+        TFuture<R>::fulfil(dst, f);
+    });
+    return res;
+}
+
+// f(a, b) после готовности обоих результатов; первым передается исключение a
+template<typename A, typename B, typename F>
+auto async_join(const TFuture<A>& a, const TFuture<B>& b, F f)
+    -> TFuture<typename std::decay<decltype(f(std::declval<const A&>(), std::declval<const B&>()))>::type>
+{
+    typedef typename std::decay<decltype(f(std::declval<const A&>(), std::declval<const B&>()))>::type R;
+    if (!a.valid() || !b.valid())
+        throw std::logic_error("Future has no state");
+    TFuture<R> res = TFuture<R>::pending();
+    std::shared_ptr<typename TFuture<A>::TState> sa = a.st;
+    std::shared_ptr<typename TFuture<B>::TState> sb = b.st;
+    std::shared_ptr<typename TFuture<R>::TState> dst = res.st;
+    // задачу ставит тот, кто последним дождался своего результата
+    std::shared_ptr<std::atomic<int>> left = std::make_shared<std::atomic<int>>(2);
+    std::function<void()> arrive = [sa, sb, dst, f, left]() {
+        if (left->fetch_sub(1, std::memory_order_acq_rel) != 1)
+            return;
+        TThreadPool::instance().submit([sa, sb, dst, f]() {
+            TMATRIX_TRACE_SCOPE("async");
+            if (sa->error)
+                TFuture<R>::finish(dst, nullptr, sa->error);
+            else if (sb->error)
+                TFuture<R>::finish(dst, nullptr, sb->error);
+            else
+                TFuture<R>::fulfil(dst, [&]() { return f(*sa->value, *sb->value); });
+        });
+    };
+    a.on_ready(arrive);
+    b.on_ready(arrive);
+    return res;
+}
+
+template<typename R>
+TFuture<R> make_ready_future(R v)
+{
+    return TFuture<R>::ready(std::move(v));
+}
+
+// Операции над готовыми матрицами получают операнды по значению:
+// задача владеет своей копией, std::move позволяет обойтись без копирования.
+// Перегрузки с TFuture ждут операнды без блокировки и строят цепочки
+template<typename T>
+TFuture<TDynamicMatrix<T>> async_multiply(TDynamicMatrix<T> a, TDynamicMatrix<T> b)
+{
+    auto pa = std::make_shared<TDynamicMatrix<T>>(std::move(a));
+    auto pb = std::make_shared<TDynamicMatrix<T>>(std::move(b));
+    return async_run([pa, pb]() { return *pa * *pb; });
+}
+template<typename T>
+TFuture<TDynamicMatrix<T>> async_multiply(const TFuture<TDynamicMatrix<T>>& a, const TFuture<TDynamicMatrix<T>>& b)
+{
+    return async_join(a, b, [](const TDynamicMatrix<T>& x, const TDynamicMatrix<T>& y) { return x * y; });
+}
+template<typename T>
+TFuture<TDynamicVector<T>> async_multiply(TDynamicMatrix<T> a, TDynamicVector<T> v)
+{
+    auto pa = std::make_shared<TDynamicMatrix<T>>(std::move(a));
+    auto pv = std::make_shared<TDynamicVector<T>>(std::move(v));
+    return async_run([pa, pv]() { return *pa * *pv; });
+}
+
+template<typename T>
+TFuture<TDynamicMatrix<T>> async_add(TDynamicMatrix<T> a, TDynamicMatrix<T> b)
+{
+    auto pa = std::make_shared<TDynamicMatrix<T>>(std::move(a));
+    auto pb = std::make_shared<TDynamicMatrix<T>>(std::move(b));
+    return async_run([pa, pb]() { return *pa + *pb; });
+}
+template<typename T>
+TFuture<TDynamicMatrix<T>> async_add(const TFuture<TDynamicMatrix<T>>& a, const TFuture<TDynamicMatrix<T>>& b)
+{
+    return async_join(a, b, [](const TDynamicMatrix<T>& x, const TDynamicMatrix<T>& y) { return x + y; });
+}
+
+template<typename T>
+TFuture<TDynamicMatrix<T>> async_sub(TDynamicMatrix<T> a, TDynamicMatrix<T> b)
+{
+    auto pa = std::make_shared<TDynamicMatrix<T>>(std::move(a));
+    auto pb = std::make_shared<TDynamicMatrix<T>>(std::move(b));
+    return async_run([pa, pb]() { return *pa - *pb; });
+}
+template<typename T>
+TFuture<TDynamicMatrix<T>> async_sub(const TFuture<TDynamicMatrix<T>>& a, const TFuture<TDynamicMatrix<T>>& b)
+{
+    return async_join(a, b, [](const TDynamicMatrix<T>& x, const TDynamicMatrix<T>& y) { return x - y; });
+}
+
+// Чтение матрицы из текстового файла: размер n, затем n * n элементов по строкам.
+// Ошибка открытия или разбора передается через будущее как std::runtime_error
+template<typename T>
+TFuture<TDynamicMatrix<T>> async_load(const std::string& path)
+{
+    return async_run([path]() {
+        TMATRIX_TRACE_SCOPE("matrix_load");
+        std::ifstream in(path);
+        if (!in)
+            throw std::runtime_error("Cannot open matrix file " + path);
+        size_t n = 0;
+        if (!(in >> n) || n == 0 || n >= (size_t)MAX_MATRIX_SIZE)
+            throw std::runtime_error("Invalid matrix size in " + path);
+        TDynamicMatrix<T> m(n);
+        if (!(in >> m))
+            throw std::runtime_error("Invalid matrix data in " + path);
+        return m;
+    });
+}
+
+#endif
@@ -0,0 +1,137 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Автонастройка параметров умножения и кэш настроек на диске
+
+#ifndef __TAutoTune_H__
+#define __TAutoTune_H__
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include "tgemm.h"
+
+// Параметры замеров
+struct TTuneOptions
+{
+    size_t size = 512;         // размер для подбора блока и порога отсечения Штрассена
+    size_t max_size = 2048;    // наибольший размер при поиске порога Штрассена
+    size_t repeats = 3;        // берется лучшее время из нескольких запусков
+};
+
+// Автонастройка параметров TGemm для типа T
+template<typename T>
+class TAutoTuner
+{
+    typedef std::chrono::steady_clock clock;
+
+    template<typename F>
+    static double measure(F&& f, size_t repeats)
+    {
+        double best = 1e300;
+        for (size_t r = 0; r < (repeats ? repeats : 1); r++) {
+            auto t0 = clock::now();
+            f();
+            best = std::min(best, std::chrono::duration<double>(clock::now() - t0).count());
+        }
+        return best;
+    }
+
+    static void fill(TMatrixBuffer<T>& m, size_t n)
+    {
+        TMatrixView<T> v = m.view();
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                v.row(i)[j] = (T)(int)((i * 7 + j * 3) % 13);
+    }
+
+    static double time_blocked(size_t n, const TGemmParams& p, size_t repeats)
+    {
+        TMatrixBuffer<T> a(n), b(n), c(n);
+        fill(a, n);
+        fill(b, n);
+        return measure([&]() { TGemm<T>::blocked(a.view(), b.view(), c.view(), n, p); }, repeats);
+    }
+    static double time_strassen(size_t n, const TGemmParams& p, size_t repeats)
+    {
+        TMatrixBuffer<T> a(n), b(n), c(n);
+        fill(a, n);
+        fill(b, n);
+        return measure([&]() { TGemm<T>::strassen(a.view(), b.view(), c.view(), n, p); }, repeats);
+    }
+public:
+    // подбор параметров, результат применяется и записывается в кэш (если путь не пуст);
+    // можно вызывать, пока другие потоки умножают матрицы типа T
+    static TGemmParams tune(const TTuneOptions& o = TTuneOptions(), const std::string& path = TTuningCache::default_path())
+    {
+        TGemmParams p = TGemmConfig<T>::snapshot();
+        p.precision_check = false;
+
+        // размер блока - на однопоточном умножении
+        TGemmParams seq = p;
+        seq.parallel_threshold = (size_t)-1;
+        double best = 1e300;
+        for (size_t bs : { 16, 32, 64, 128, 256 }) {
+            if (bs > o.size)
+                break;
+            seq.block_size = bs;
+            double t = time_blocked(o.size, seq, o.repeats);
+            if (t < best) {
+                best = t;
+                p.block_size = bs;
+            }
+        }
+        seq.block_size = p.block_size;
+
+        // порог распараллеливания - наименьший размер, где потоки выигрывают
+        TGemmParams par = seq;
+        par.parallel_threshold = 0;
+        p.parallel_threshold = (size_t)-1;
+        for (size_t n = 32; n <= o.size; n *= 2)
+            if (time_blocked(n, par, o.repeats) < time_blocked(n, seq, o.repeats)) {
+                p.parallel_threshold = n;
+                break;
+            }
+
+        // порог отсечения рекурсии Штрассена
+        TGemmParams str = p;
+        best = 1e300;
+        for (size_t cut = 32; cut < o.size; cut *= 2) {
+            str.strassen_cutoff = cut;
+            double t = time_strassen(o.size, str, o.repeats);
+            if (t < best) {
+                best = t;
+                p.strassen_cutoff = cut;
+            }
+        }
+
+        // порог включения Штрассена - если не окупается до max_size, остается прежним
+        str.strassen_cutoff = p.strassen_cutoff;
+        for (size_t n = 2 * p.strassen_cutoff; n <= o.max_size; n *= 2)
+            if (time_strassen(n, str, o.repeats) < time_blocked(n, p, o.repeats)) {
+                p.strassen_threshold = n;
+                break;
+            }
+
+        // замена под блокировкой: умножения в других потоках берут копию параметров
+        TGemmParams cur;
+        {
+            std::lock_guard<std::mutex> lk(TGemmConfig<T>::lock());
+            TGemmParams& g = TGemmConfig<T>::params();
+            g.block_size = p.block_size;
+            g.parallel_threshold = p.parallel_threshold;
+            g.strassen_threshold = p.strassen_threshold;
+            g.strassen_cutoff = p.strassen_cutoff;
+            cur = g;
+        }
+        if (!path.empty()) {
+            TTuningCache cache;
+            cache.load(path);
+            cache.set<T>(cur);
+            cache.save(path);
+        }
+        return cur;
+    }
+};
+
+#endif
@@ -0,0 +1,275 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Пакеты малых матриц одинакового размера
+
+#ifndef __TBatchMatrix_H__
+#define __TBatchMatrix_H__
+
+#include <cmath>
+#include <vector>
+#include "tmatrix.h"
+#include "tparallel.h"
+
+// Число матриц в одной группе - столько, сколько помещается в регистр AVX
+template<typename T>
+struct TBatchLanes
+{
+    static constexpr size_t value = sizeof(T) >= 32 ? 1 : 32 / sizeof(T);
+};
+
+// Пакет векторов длины n в чередующейся раскладке:
+// элемент i вектора b хранится в data[((b / L) * n + i) * L + b % L]
+template<typename T>
+class TBatchVector
+{
+public:
+    static constexpr size_t L = TBatchLanes<T>::value;
+protected:
+    size_t cnt, n;
+    std::vector<T> mem;
+public:
+    TBatchVector(size_t count, size_t size) : cnt(count), n(size)
+    {
+        if (count == 0 || size == 0)
+            throw std::out_of_range("Batch count and vector size should be greater than zero");
+        mem.assign(groups() * n * L, T());
+    }
+
+    size_t count() const noexcept { return cnt; }
+    size_t size() const noexcept { return n; }
+    size_t groups() const noexcept { return (cnt + L - 1) / L; }
+
+    T* group(size_t g) noexcept { return mem.data() + g * n * L; }
+    const T* group(size_t g) const noexcept { return mem.data() + g * n * L; }
+
+    T& operator()(size_t b, size_t i)
+    {
+        if (b >= cnt || i >= n)
+            throw std::out_of_range("Too large index");
+        return group(b / L)[i * L + b % L];
+    }
+    const T& operator()(size_t b, size_t i) const
+    {
+        if (b >= cnt || i >= n)
+            throw std::out_of_range("Too large index");
+        return group(b / L)[i * L + b % L];
+    }
+
+    void set(size_t b, const TDynamicVector<T>& v)
+    {
+        if (v.size() != n)
+            throw std::invalid_argument("Vector size does not match the batch");
+        for (size_t i = 0; i < n; i++)
+            (*this)(b, i) = v[i];
+    }
+    TDynamicVector<T> get(size_t b) const
+    {
+        TDynamicVector<T> v(n);
+        for (size_t i = 0; i < n; i++)
+            v[i] = (*this)(b, i);
+        return v;
+    }
+};
+
+// Пакет матриц n x n в чередующейся раскладке (структура массивов):
+// элемент (i, j) матрицы b хранится в data[((b / L) * n * n + i * n + j) * L + b % L],
+// поэтому внутренний цикл по L матрицам группы векторизуется
+template<typename T>
+class TBatchMatrix
+{
+public:
+    static constexpr size_t L = TBatchLanes<T>::value;
+    static constexpr size_t GRAIN = 64;  // групп на задачу пула
+protected:
+    size_t cnt, n;
+    std::vector<T> mem;
+
+    template<typename F>
+    static void for_groups(size_t groups, F&& f)
+    {
+        parallel_for(0, groups, GRAIN, [&](size_t g0, size_t g1) {
+            for (size_t g = g0; g < g1; g++)
+                f(g);
+        });
+    }
+public:
+    TBatchMatrix(size_t count, size_t size) : cnt(count), n(size)
+    {
+        if (count == 0 || size == 0)
+            throw std::out_of_range("Batch count and matrix size should be greater than zero");
+        mem.assign(groups() * n * n * L, T());
+    }
+
+    size_t count() const noexcept { return cnt; }
+    size_t size() const noexcept { return n; }
+    size_t groups() const noexcept { return (cnt + L - 1) / L; }
+
+    T* group(size_t g) noexcept { return mem.data() + g * n * n * L; }
+    const T* group(size_t g) const noexcept { return mem.data() + g * n * n * L; }
+
+    T& operator()(size_t b, size_t i, size_t j)
+    {
+        if (b >= cnt || i >= n || j >= n)
+            throw std::out_of_range("Too large index");
+        return group(b / L)[(i * n + j) * L + b % L];
+    }
+    const T& operator()(size_t b, size_t i, size_t j) const
+    {
+        if (b >= cnt || i >= n || j >= n)
+            throw std::out_of_range("Too large index");
+        return group(b / L)[(i * n + j) * L + b % L];
+    }
+
+    void set(size_t b, const TDynamicMatrix<T>& m)
+    {
+        if (m.size() != n)
+            throw std::invalid_argument("Matrix size does not match the batch");
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                (*this)(b, i, j) = m[i][j];
+    }
+    TDynamicMatrix<T> get(size_t b) const
+    {
+        TDynamicMatrix<T> m(n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                m[i][j] = (*this)(b, i, j);
+        return m;
+    }
+
+    // поэлементные операции над всем пакетом
+    TBatchMatrix operator+(const TBatchMatrix& m) const
+    {
+        if (cnt != m.cnt || n != m.n)
+            throw std::invalid_argument("Batches must have the same shape");
+        TBatchMatrix res(cnt, n);
+        const size_t len = n * n * L;
+        for_groups(groups(), [&](size_t g) {
+            const T* pa = group(g);
+            const T* pb = m.group(g);
+            T* pc = res.group(g);
+            for (size_t k = 0; k < len; k++)
+                pc[k] = pa[k] + pb[k];
+        });
+        return res;
+    }
+    TBatchMatrix operator-(const TBatchMatrix& m) const
+    {
+        if (cnt != m.cnt || n != m.n)
+            throw std::invalid_argument("Batches must have the same shape");
+        TBatchMatrix res(cnt, n);
+        const size_t len = n * n * L;
+        for_groups(groups(), [&](size_t g) {
+            const T* pa = group(g);
+            const T* pb = m.group(g);
+            T* pc = res.group(g);
+            for (size_t k = 0; k < len; k++)
+                pc[k] = pa[k] - pb[k];
+        });
+        return res;
+    }
+
+    // попарные произведения матриц пакетов
+    TBatchMatrix operator*(const TBatchMatrix& m) const
+    {
+        if (cnt != m.cnt || n != m.n)
+            throw std::invalid_argument("Batches must have the same shape");
+        TBatchMatrix res(cnt, n);
+        const size_t nn = n;
+        for_groups(groups(), [&](size_t g) {
+            const T* pa = group(g);
+            const T* pb = m.group(g);
+            T* pc = res.group(g);
+            for (size_t i = 0; i < nn; i++)
+                for (size_t k = 0; k < nn; k++) {
+                    const T* a = pa + (i * nn + k) * L;
+                    const T* b = pb + k * nn * L;
+                    T* c = pc + i * nn * L;
+                    for (size_t j = 0; j < nn; j++)
+                        for (size_t l = 0; l < L; l++)
+                            c[j * L + l] += a[l] * b[j * L + l];
+                }
+        });
+        return res;
+    }
+
+    // произведения матриц на векторы пакета
+    TBatchVector<T> operator*(const TBatchVector<T>& v) const
+    {
+        if (cnt != v.count() || n != v.size())
+            throw std::invalid_argument("Batches must have the same shape");
+        TBatchVector<T> res(cnt, n);
+        const size_t nn = n;
+        for_groups(groups(), [&](size_t g) {
+            const T* pa = group(g);
+            const T* px = v.group(g);
+            T* py = res.group(g);
+            for (size_t i = 0; i < nn; i++)
+                for (size_t k = 0; k < nn; k++) {
+                    const T* a = pa + (i * nn + k) * L;
+                    for (size_t l = 0; l < L; l++)
+                        py[i * L + l] += a[l] * px[k * L + l];
+                }
+        });
+        return res;
+    }
+
+    // решение систем A_b x_b = f_b методом Гаусса с выбором главного элемента
+    // в каждой матрице; исключение идет сразу по всем L матрицам группы
+    TBatchVector<T> solve(const TBatchVector<T>& f) const
+    {
+        TMATRIX_TRACE_SCOPE("batch_solve");
+        if (cnt != f.count() || n != f.size())
+            throw std::invalid_argument("Batches must have the same shape");
+        TBatchVector<T> x(f);
+        const size_t nn = n;
+        const size_t last = cnt - (groups() - 1) * L;  // занятых дорожек в последней группе
+        const size_t last_group = groups() - 1;
+        for_groups(groups(), [&](size_t g) {
+            std::vector<T> a(group(g), group(g) + nn * nn * L);
+            T* px = x.group(g);
+            const size_t used = g == last_group ? last : L;
+            for (size_t k = 0; k < nn; k++) {
+                for (size_t l = 0; l < used; l++) {
+                    size_t piv = k;
+                    for (size_t i = k + 1; i < nn; i++)
+                        if (std::abs(a[(i * nn + k) * L + l]) > std::abs(a[(piv * nn + k) * L + l]))
+                            piv = i;
+                    if (a[(piv * nn + k) * L + l] == T())
+                        throw std::invalid_argument("Singular matrix in batch");
+                    if (piv != k) {
+                        for (size_t j = k; j < nn; j++)
+                            std::swap(a[(k * nn + j) * L + l], a[(piv * nn + j) * L + l]);
+                        std::swap(px[k * L + l], px[piv * L + l]);
+                    }
+                }
+                // пустые дорожки последней группы получают единичную диагональ
+                for (size_t l = used; l < L; l++)
+                    a[(k * nn + k) * L + l] = T(1);
+                T inv[L];
+                for (size_t l = 0; l < L; l++)
+                    inv[l] = T(1) / a[(k * nn + k) * L + l];
+                for (size_t i = k + 1; i < nn; i++) {
+                    T fac[L];
+                    for (size_t l = 0; l < L; l++)
+                        fac[l] = a[(i * nn + k) * L + l] * inv[l];
+                    for (size_t j = k; j < nn; j++)
+                        for (size_t l = 0; l < L; l++)
+                            a[(i * nn + j) * L + l] -= fac[l] * a[(k * nn + j) * L + l];
+                    for (size_t l = 0; l < L; l++)
+                        px[i * L + l] -= fac[l] * px[k * L + l];
+                }
+            }
+            for (size_t k = nn; k-- > 0;) {
+                for (size_t j = k + 1; j < nn; j++)
+                    for (size_t l = 0; l < L; l++)
+                        px[k * L + l] -= a[(k * nn + j) * L + l] * px[j * L + l];
+                for (size_t l = 0; l < L; l++)
+                    px[k * L + l] /= a[(k * nn + k) * L + l];
+            }
+        });
+        return x;
+    }
+};
+
+#endif
@@ -0,0 +1,288 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Битовые булевы матрицы: 64 элемента в машинном слове
+
+#ifndef __TBitMatrix_H__
+#define __TBitMatrix_H__
+
+#include <cstdint>
+#include <vector>
+#include "tmatrix.h"
+#include "tparallel.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// Число единичных битов слова
+inline size_t popcount64(uint64_t x) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (size_t)__builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (size_t)__popcnt64(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (size_t)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Булева матрица n x n, строка - массив из words() слов;
+// биты за пределами n в последнем слове строки всегда нулевые
+class TBitMatrix
+{
+public:
+    static constexpr size_t BITS = 64;
+    static constexpr size_t GROUP = 8;          // бит A на одну таблицу "четырех русских"
+    static constexpr size_t TABLES = 8;         // таблиц на проход по строкам A
+    static constexpr size_t PARALLEL_SIZE = 256;
+protected:
+    size_t n, w;
+    std::vector<uint64_t> mem;
+
+    // строки [r0, r1) результата по 8 * TABLES строкам B начиная с k0
+    void apply_tables(const uint64_t* tab, size_t k0, size_t cnt, TBitMatrix& c, size_t r0, size_t r1) const
+    {
+        const size_t tsize = size_t(1) << GROUP;
+        for (size_t i = r0; i < r1; i++) {
+            const uint64_t* pa = row(i);
+            uint64_t* pc = c.row(i);
+            for (size_t t = 0; t < cnt; t++) {
+                size_t k = k0 + t * GROUP;
+                size_t idx = (size_t)(pa[k / BITS] >> (k % BITS)) & (tsize - 1);
+                if (idx == 0)
+                    continue;
+                const uint64_t* pt = tab + (t * tsize + idx) * c.w;
+                for (size_t q = 0; q < c.w; q++)
+                    pc[q] |= pt[q];
+            }
+        }
+    }
+public:
+    TBitMatrix(size_t size = 1) : n(size), w((size + BITS - 1) / BITS)
+    {
+        if (size == 0)
+            throw std::out_of_range("Matrix size should be greater than zero");
+        if (size >= (size_t)MAX_MATRIX_SIZE)
+            throw std::out_of_range("Matrix size should be less than MAX_MATRIX_SIZE");
+        mem.assign(n * w, 0);
+    }
+    // ненулевые элементы считаются единицами
+    template<typename T>
+    explicit TBitMatrix(const TDynamicMatrix<T>& m) : TBitMatrix(m.size())
+    {
+        for (size_t i = 0; i < n; i++) {
+            const T* p = m[i].data();
+            uint64_t* r = row(i);
+            for (size_t j = 0; j < n; j++)
+                if (p[j] != T())
+                    r[j / BITS] |= uint64_t(1) << (j % BITS);
+        }
+    }
+
+    size_t size() const noexcept { return n; }
+    size_t words() const noexcept { return w; }
+    uint64_t* row(size_t i) noexcept { return mem.data() + i * w; }
+    const uint64_t* row(size_t i) const noexcept { return mem.data() + i * w; }
+
+    bool get(size_t i, size_t j) const
+    {
+        if (i >= n || j >= n)
+            throw std::out_of_range("Too large index");
+        return (row(i)[j / BITS] >> (j % BITS)) & 1;
+    }
+    void set(size_t i, size_t j, bool val = true)
+    {
+        if (i >= n || j >= n)
+            throw std::out_of_range("Too large index");
+        uint64_t bit = uint64_t(1) << (j % BITS);
+        if (val)
+            row(i)[j / BITS] |= bit;
+        else
+            row(i)[j / BITS] &= ~bit;
+    }
+    bool operator()(size_t i, size_t j) const { return get(i, j); }
+
+    template<typename T>
+    TDynamicMatrix<T> to_matrix() const
+    {
+        TDynamicMatrix<T> m(n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                m[i][j] = ((row(i)[j / BITS] >> (j % BITS)) & 1) ? T(1) : T();
+        return m;
+    }
+
+    static TBitMatrix identity(size_t size)
+    {
+        TBitMatrix m(size);
+        for (size_t i = 0; i < size; i++)
+            m.row(i)[i / BITS] |= uint64_t(1) << (i % BITS);
+        return m;
+    }
+
+    bool operator==(const TBitMatrix& m) const noexcept
+    {
+        return n == m.n && mem == m.mem;
+    }
+    bool operator!=(const TBitMatrix& m) const noexcept
+    {
+        return !(*this == m);
+    }
+
+    // поэлементные операции - по словам
+    TBitMatrix operator&(const TBitMatrix& m) const
+    {
+        if (n != m.n)
+            throw std::invalid_argument("Matrix sizes should be equal");
+        TBitMatrix res(n);
+        for (size_t q = 0; q < mem.size(); q++)
+            res.mem[q] = mem[q] & m.mem[q];
+        return res;
+    }
+    TBitMatrix operator|(const TBitMatrix& m) const
+    {
+        if (n != m.n)
+            throw std::invalid_argument("Matrix sizes should be equal");
+        TBitMatrix res(n);
+        for (size_t q = 0; q < mem.size(); q++)
+            res.mem[q] = mem[q] | m.mem[q];
+        return res;
+    }
+    TBitMatrix operator^(const TBitMatrix& m) const
+    {
+        if (n != m.n)
+            throw std::invalid_argument("Matrix sizes should be equal");
+        TBitMatrix res(n);
+        for (size_t q = 0; q < mem.size(); q++)
+            res.mem[q] = mem[q] ^ m.mem[q];
+        return res;
+    }
+
+    // число единиц во всей матрице и в строке i
+    size_t count() const noexcept
+    {
+        size_t s = 0;
+        for (uint64_t x : mem)
+            s += popcount64(x);
+        return s;
+    }
+    size_t count(size_t i) const
+    {
+        if (i >= n)
+            throw std::out_of_range("Too large index");
+        size_t s = 0;
+        for (size_t q = 0; q < w; q++)
+            s += popcount64(row(i)[q]);
+        return s;
+    }
+
+    // |row_i(this) & row_j(m)| - число общих соседей, скалярное произведение строк
+    size_t intersect(size_t i, const TBitMatrix& m, size_t j) const
+    {
+        if (n != m.n)
+            throw std::invalid_argument("Matrix sizes should be equal");
+        if (i >= n || j >= n)
+            throw std::out_of_range("Too large index");
+        const uint64_t* a = row(i);
+        const uint64_t* b = m.row(j);
+        size_t s = 0;
+        for (size_t q = 0; q < w; q++)
+            s += popcount64(a[q] & b[q]);
+        return s;
+    }
+
+    TBitMatrix transpose() const
+    {
+        TMATRIX_TRACE_SCOPE("bit_transpose");
+        TBitMatrix res(n);
+        for (size_t i = 0; i < n; i++) {
+            const uint64_t* p = row(i);
+            for (size_t j = 0; j < n; j++)
+                if ((p[j / BITS] >> (j % BITS)) & 1)
+                    res.row(j)[i / BITS] |= uint64_t(1) << (i % BITS);
+        }
+        return res;
+    }
+
+    // Булево произведение методом "четырех русских": для каждой группы из 8 строк B
+    // строится таблица всех 256 их дизъюнкций, и строка C набирается по байтам строки A.
+    // Таблицы строятся пачками по TABLES штук, чтобы помещаться в кэш,
+    // строки A внутри пачки делятся между потоками
+    TBitMatrix operator*(const TBitMatrix& m) const
+    {
+        TMATRIX_TRACE_SCOPE("bit_product");
+        if (n != m.n)
+            throw std::invalid_argument("Matrix sizes are incompatible for multiplication");
+        TBitMatrix res(n);
+        const size_t tsize = size_t(1) << GROUP;
+        std::vector<uint64_t> tab(TABLES * tsize * w);
+        for (size_t k0 = 0; k0 < n; k0 += GROUP * TABLES) {
+            size_t cnt = std::min(TABLES, (n - k0 + GROUP - 1) / GROUP);
+            for (size_t t = 0; t < cnt; t++) {
+                uint64_t* pt = tab.data() + t * tsize * w;
+                std::fill(pt, pt + w, 0);
+                size_t kb = k0 + t * GROUP;
+                size_t bits = std::min(GROUP, n - kb);
+                // T[2^b + x] = T[x] | B[kb + b]
+                for (size_t b = 0; b < bits; b++) {
+                    const uint64_t* pb = m.row(kb + b);
+                    size_t half = size_t(1) << b;
+                    for (size_t x = 0; x < half; x++) {
+                        const uint64_t* src = pt + x * w;
+                        uint64_t* dst = pt + (half + x) * w;
+                        for (size_t q = 0; q < w; q++)
+                            dst[q] = src[q] | pb[q];
+                    }
+                }
+            }
+            if (n < PARALLEL_SIZE)
+                apply_tables(tab.data(), k0, cnt, res, 0, n);
+            else
+                parallel_for(0, n, 64, [&](size_t r0, size_t r1) {
+                    apply_tables(tab.data(), k0, cnt, res, r0, r1);
+                });
+        }
+        return res;
+    }
+
+    // Транзитивное замыкание A+ (пути длины >= 1) алгоритмом Уоршелла:
+    // если i достигает k, строка i поглощает строку k целиком по словам
+    TBitMatrix closure() const
+    {
+        TMATRIX_TRACE_SCOPE("bit_closure");
+        TBitMatrix res(*this);
+        for (size_t k = 0; k < n; k++) {
+            const uint64_t* pk = res.row(k);
+            const uint64_t mask = uint64_t(1) << (k % BITS);
+            const size_t wk = k / BITS;
+            auto body = [&](size_t r0, size_t r1) {
+                for (size_t i = r0; i < r1; i++) {
+                    uint64_t* pi = res.row(i);
+                    if (i != k && (pi[wk] & mask))
+                        for (size_t q = 0; q < w; q++)
+                            pi[q] |= pk[q];
+                }
+            };
+            if (n < PARALLEL_SIZE)
+                body(0, n);
+            else
+                parallel_for(0, n, 64, body);
+        }
+        return res;
+    }
+
+    friend ostream& operator<<(ostream& ostr, const TBitMatrix& m)
+    {
+        for (size_t i = 0; i < m.n; i++) {
+            for (size_t j = 0; j < m.n; j++)
+                ostr << m.get(i, j) << ' ';
+            ostr << endl;
+        }
+        return ostr;
+    }
+};
+
+#endif
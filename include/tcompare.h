@@ -0,0 +1,128 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Приближенное сравнение векторов и матриц
+
+#ifndef __TCompare_H__
+#define __TCompare_H__
+
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "tmatrix.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+// Проверка |a[i] - b[i]| <= atol + rtol * |b[i]| для всех i, как numpy.allclose
+// (допуск считается от второго аргумента). Равные элементы, в том числе
+// бесконечности одного знака, считаются близкими; NaN и конечное число
+// рядом с бесконечностью - нет: допуск ограничен наибольшим конечным числом
+template<typename T>
+class TAllClose
+{
+    typedef typename TComputeType<T>::type C;
+    typedef typename std::conditional<std::is_floating_point<C>::value, C, double>::type N;
+public:
+    static constexpr size_t BLOCK = 1024;  // элементов между проверками раннего выхода
+
+    // число нарушений в [0, n) - без ветвлений, чтобы цикл векторизовался
+    static size_t violations(const T* a, const T* b, size_t n, N rtol, N atol) noexcept
+    {
+        const N big = std::numeric_limits<N>::max();
+        size_t bad = 0;
+        for (size_t i = 0; i < n; i++) {
+            N x = N(C(a[i])), y = N(C(b[i]));
+            N tol = atol + rtol * std::abs(y);
+            bad += !(x == y || std::abs(x - y) <= (tol < big ? tol : big));
+        }
+        return bad;
+    }
+
+    static bool run(const T* a, const T* b, size_t n, double rtol, double atol)
+    {
+        for (size_t i = 0; i < n; i += BLOCK)
+            if (violations(a + i, b + i, std::min(BLOCK, n - i), N(rtol), N(atol)))
+                return false;
+        return true;
+    }
+};
+
+#if defined(__AVX__)
+template<>
+inline size_t TAllClose<double>::violations(const double* a, const double* b, size_t n, double rtol, double atol) noexcept
+{
+    const __m256d sign = _mm256_set1_pd(-0.0), vr = _mm256_set1_pd(rtol), va = _mm256_set1_pd(atol);
+    const __m256d big = _mm256_set1_pd(std::numeric_limits<double>::max());
+    size_t res = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d x = _mm256_loadu_pd(a + i), y = _mm256_loadu_pd(b + i);
+        __m256d d = _mm256_andnot_pd(sign, _mm256_sub_pd(x, y));
+        __m256d tol = _mm256_min_pd(_mm256_add_pd(va, _mm256_mul_pd(vr, _mm256_andnot_pd(sign, y))), big);
+        __m256d ok = _mm256_or_pd(_mm256_cmp_pd(x, y, _CMP_EQ_OQ), _mm256_cmp_pd(d, tol, _CMP_LE_OQ));
+        // нарушения - нулевые биты маски ok среди 4 дорожек
+        res += 4 - std::popcount((unsigned)_mm256_movemask_pd(ok));
+    }
+    for (; i < n; i++)
+        res += !(a[i] == b[i] || std::abs(a[i] - b[i]) <= std::min(atol + rtol * std::abs(b[i]), std::numeric_limits<double>::max()));
+    return res;
+}
+template<>
+inline size_t TAllClose<float>::violations(const float* a, const float* b, size_t n, float rtol, float atol) noexcept
+{
+    const __m256 sign = _mm256_set1_ps(-0.0f), vr = _mm256_set1_ps(rtol), va = _mm256_set1_ps(atol);
+    const __m256 big = _mm256_set1_ps(std::numeric_limits<float>::max());
+    size_t res = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(a + i), y = _mm256_loadu_ps(b + i);
+        __m256 d = _mm256_andnot_ps(sign, _mm256_sub_ps(x, y));
+        __m256 tol = _mm256_min_ps(_mm256_add_ps(va, _mm256_mul_ps(vr, _mm256_andnot_ps(sign, y))), big);
+        __m256 ok = _mm256_or_ps(_mm256_cmp_ps(x, y, _CMP_EQ_OQ), _mm256_cmp_ps(d, tol, _CMP_LE_OQ));
+        // нарушения - нулевые биты маски ok среди 8 дорожек
+        res += 8 - std::popcount((unsigned)_mm256_movemask_ps(ok));
+    }
+    for (; i < n; i++)
+        res += !(a[i] == b[i] || std::abs(a[i] - b[i]) <= std::min(atol + rtol * std::abs(b[i]), std::numeric_limits<float>::max()));
+    return res;
+}
+#endif
+
+template<typename T>
+bool all_close(const TDynamicVector<T>& a, const TDynamicVector<T>& b, double rtol = 1e-5, double atol = 1e-8)
+{
+    if (a.size() != b.size())
+        return false;
+    size_t n = a.size();
+    if (!TParallelConfig::use_parallel(n))
+        return TAllClose<T>::run(a.data(), b.data(), n, rtol, atol);
+    std::atomic<bool> close(true);
+    parallel_for_aligned(n, TAllClose<T>::BLOCK, [&](size_t s, size_t e) {
+        for (size_t i = s; i < e && close.load(std::memory_order_relaxed); i += TAllClose<T>::BLOCK)
+            if (!TAllClose<T>::run(a.data() + i, b.data() + i, std::min(e, i + TAllClose<T>::BLOCK) - i, rtol, atol))
+                close.store(false, std::memory_order_relaxed);
+    });
+    return close.load();
+}
+
+template<typename T>
+bool all_close(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, double rtol = 1e-5, double atol = 1e-8)
+{
+    if (a.size() != b.size())
+        return false;
+    size_t n = a.size();
+    std::atomic<bool> close(true);
+    auto body = [&](size_t r0, size_t r1) {
+        for (size_t i = r0; i < r1 && close.load(std::memory_order_relaxed); i++)
+            if (!TAllClose<T>::run(a[i].data(), b[i].data(), n, rtol, atol))
+                close.store(false, std::memory_order_relaxed);
+    };
+    if (TParallelConfig::use_parallel(n * n))
+        parallel_for(0, n, 1, body);
+    else
+        body(0, n);
+    return close.load();
+}
+
+#endif
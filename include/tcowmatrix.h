@@ -0,0 +1,185 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Матрица с разделяемым хранилищем (copy-on-write)
+
+#ifndef __TCowMatrix_H__
+#define __TCowMatrix_H__
+
+#include <atomic>
+#include <stdexcept>
+#include "tmatrix.h"
+
+// Матрица с копированием при записи -
+// копии разделяют один буфер со счетчиком ссылок,
+// клонирование происходит при первом изменяющем доступе.
+// Неконстантные operator[] и mutable_matrix выдают ссылки, которые живут
+// дольше вызова, поэтому после них буфер больше не разделяется: копии такой
+// матрицы сразу получают свои данные. Перемещенная матрица пуста (size() == 0),
+// доступ к ее элементам бросает std::logic_error
+template<typename T>
+class TCowMatrix
+{
+    struct TBuffer
+    {
+        std::atomic<size_t> refs;
+        bool unshareable = false;   // выдана изменяющая ссылка
+        TDynamicMatrix<T> m;
+
+        TBuffer(const TDynamicMatrix<T>& src) : refs(1), m(src) {}
+        TBuffer(TDynamicMatrix<T>&& src) : refs(1), m(std::move(src)) {}
+    };
+    TBuffer* buf;
+
+    TBuffer& get() const
+    {
+        if (!buf)
+            throw std::logic_error("Matrix has been moved from");
+        return *buf;
+    }
+    // буфер для новой копии c: общий или, если он не разделяется, собственный
+    static TBuffer* share(const TCowMatrix& c)
+    {
+        if (c.buf && c.buf->unshareable)
+            return new TBuffer(c.buf->m);
+        c.acquire();
+        return c.buf;
+    }
+    // изменяющий доступ: свой буфер, который больше не разделяется
+    TDynamicMatrix<T>& own()
+    {
+        get();
+        detach();
+        buf->unshareable = true;
+        return buf->m;
+    }
+
+    void acquire() const noexcept
+    {
+        if (buf)
+            buf->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+    void release() noexcept
+    {
+        // последний владелец должен увидеть все записи остальных
+        if (buf && buf->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            delete buf;
+        buf = nullptr;
+    }
+public:
+    TCowMatrix(size_t s = 1) : buf(new TBuffer(TDynamicMatrix<T>(s))) {}
+    TCowMatrix(const TDynamicMatrix<T>& m) : buf(new TBuffer(m)) {}
+    TCowMatrix(TDynamicMatrix<T>&& m) : buf(new TBuffer(std::move(m))) {}
+    TCowMatrix(const TCowMatrix& c) : buf(share(c)) {}
+    TCowMatrix(TCowMatrix&& c) noexcept : buf(c.buf)
+    {
+        c.buf = nullptr;
+    }
+    ~TCowMatrix()
+    {
+        release();
+    }
+
+    TCowMatrix& operator=(const TCowMatrix& c)
+    {
+        if (this != &c) {
+            TBuffer* p = share(c);
+            release();
+            buf = p;
+        }
+        return *this;
+    }
+    TCowMatrix& operator=(TCowMatrix&& c) noexcept
+    {
+        if (this != &c) {
+            release();
+            buf = c.buf;
+            c.buf = nullptr;
+        }
+        return *this;
+    }
+
+    size_t size() const noexcept { return buf ? buf->m.size() : 0; }
+
+    // число владельцев общего буфера
+    size_t use_count() const noexcept
+    {
+        return buf ? buf->refs.load(std::memory_order_acquire) : 0;
+    }
+    bool shared() const noexcept { return use_count() > 1; }
+
+    // явное отделение от общего буфера - после него
+    // неконстантный доступ в горячих циклах не копирует данные
+    void detach()
+    {
+        if (buf && buf->refs.load(std::memory_order_acquire) != 1) {
+            TBuffer* p = new TBuffer(buf->m);
+            release();
+            buf = p;
+        }
+    }
+
+    // индексация: чтение не копирует, запись отделяет буфер
+    const TDynamicVector<T>& operator[](size_t index) const
+    {
+        return static_cast<const TDynamicMatrix<T>&>(get().m)[index];
+    }
+    TDynamicVector<T>& operator[](size_t index)
+    {
+        return own()[index];
+    }
+
+    const TDynamicMatrix<T>& matrix() const { return get().m; }
+    TDynamicMatrix<T>& mutable_matrix()
+    {
+        return own();
+    }
+
+    // сравнение
+    bool operator==(const TCowMatrix& c) const
+    {
+        if (buf == c.buf)
+            return true;
+        return buf && c.buf && buf->m == c.buf->m;
+    }
+    bool operator!=(const TCowMatrix& c) const
+    {
+        return !(*this == c);
+    }
+
+    // операции - результат получает собственный буфер
+    TCowMatrix operator*(const T& val) const
+    {
+        return TCowMatrix(get().m * val);
+    }
+    TDynamicVector<T> operator*(const TDynamicVector<T>& v) const
+    {
+        return get().m * v;
+    }
+    TCowMatrix operator+(const TCowMatrix& c) const
+    {
+        return TCowMatrix(get().m + c.get().m);
+    }
+    TCowMatrix operator-(const TCowMatrix& c) const
+    {
+        return TCowMatrix(get().m - c.get().m);
+    }
+    TCowMatrix operator*(const TCowMatrix& c) const
+    {
+        return TCowMatrix(get().m * c.get().m);
+    }
+
+    // ввод/вывод
+    friend istream& operator>>(istream& istr, TCowMatrix& c)
+    {
+        // ссылка не выходит наружу, буфер остается разделяемым
+        c.get();
+        c.detach();
+        return istr >> c.buf->m;
+    }
+    friend ostream& operator<<(ostream& ostr, const TCowMatrix& c)
+    {
+        return ostr << c.matrix();
+    }
+};
+
+#endif
@@ -0,0 +1,235 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Поэлементные операции: произведения Адамара и Кронекера, map/zip/reduce
+
+#ifndef __TElementwise_H__
+#define __TElementwise_H__
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tmatrix.h"
+#include "tparallel.h"
+
+// map, zip и reduce над векторами и матрицами. Функции передаются шаблонным
+// параметром и встраиваются в циклы по непрерывной памяти, поэтому компилятор
+// их векторизует; большие входы делятся между потоками, как в TDynamicVector.
+// Класс со статическими методами, чтобы имена не сталкивались с std::map и std::reduce
+class TElementwise
+{
+public:
+    static constexpr size_t REDUCE_BLOCK = 8192;
+private:
+    template<typename T, typename F>
+    static void for_range(size_t n, F&& f)
+    {
+        if (TParallelConfig::use_parallel(n))
+            parallel_for_aligned(n, 4096 / sizeof(T) ? 4096 / sizeof(T) : 1, f);
+        else
+            f(size_t(0), n);
+    }
+    // по строкам матрицы n x n
+    template<typename F>
+    static void for_rows(size_t n, F&& f)
+    {
+        if (TParallelConfig::use_parallel(n * n))
+            parallel_for(0, n, 1, f);
+        else
+            f(size_t(0), n);
+    }
+
+    // свертка блоками по REDUCE_BLOCK: частичные результаты складываются в
+    // фиксированном порядке, поэтому ответ не зависит от числа потоков
+    template<typename A, typename T, typename M, typename Op>
+    static A fold(const T* p, size_t n, A identity, M&& m, Op&& op)
+    {
+        size_t blocks = (n + REDUCE_BLOCK - 1) / REDUCE_BLOCK;
+        std::vector<A> part(blocks, identity);
+        auto body = [&](size_t b0, size_t b1) {
+            for (size_t b = b0; b < b1; b++) {
+                A acc = identity;
+                size_t e = std::min(n, (b + 1) * REDUCE_BLOCK);
+                for (size_t i = b * REDUCE_BLOCK; i < e; i++)
+                    acc = op(acc, m(p[i]));
+                part[b] = acc;
+            }
+        };
+        if (TParallelConfig::use_parallel(n))
+            parallel_for(0, blocks, 1, body);
+        else
+            body(0, blocks);
+        A res = identity;
+        for (size_t b = 0; b < blocks; b++)
+            res = op(res, part[b]);
+        return res;
+    }
+public:
+    // r[i] = f(v[i])
+    template<typename T, typename F>
+    static auto map(const TDynamicVector<T>& v, F f) -> TDynamicVector<typename std::decay<decltype(f(v.data()[0]))>::type>
+    {
+        typedef typename std::decay<decltype(f(v.data()[0]))>::type R;
+        TDynamicVector<R> res(v.size());
+        const T* pv = v.data();
+        R* pr = res.data();
+        for_range<T>(v.size(), [&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                pr[i] = f(pv[i]);
+        });
+        return res;
+    }
+    template<typename T, typename F>
+    static auto map(const TDynamicMatrix<T>& m, F f) -> TDynamicMatrix<typename std::decay<decltype(f(m[0].data()[0]))>::type>
+    {
+        typedef typename std::decay<decltype(f(m[0].data()[0]))>::type R;
+        size_t n = m.size();
+        TDynamicMatrix<R> res(n);
+        for_rows(n, [&](size_t r0, size_t r1) {
+            for (size_t i = r0; i < r1; i++) {
+                const T* pm = m[i].data();
+                R* pr = res[i].data();
+                for (size_t j = 0; j < n; j++)
+                    pr[j] = f(pm[j]);
+            }
+        });
+        return res;
+    }
+
+    // r[i] = f(a[i], b[i])
+    template<typename T, typename U, typename F>
+    static auto zip(const TDynamicVector<T>& a, const TDynamicVector<U>& b, F f)
+        -> TDynamicVector<typename std::decay<decltype(f(a.data()[0], b.data()[0]))>::type>
+    {
+        typedef typename std::decay<decltype(f(a.data()[0], b.data()[0]))>::type R;
+        if (a.size() != b.size())
+            throw std::invalid_argument("Vector sizes should be equal");
+        TDynamicVector<R> res(a.size());
+        const T* pa = a.data();
+        const U* pb = b.data();
+        R* pr = res.data();
+        for_range<T>(a.size(), [&](size_t s, size_t e) {
+            for (size_t i = s; i < e; i++)
+                pr[i] = f(pa[i], pb[i]);
+        });
+        return res;
+    }
+    template<typename T, typename U, typename F>
+    static auto zip(const TDynamicMatrix<T>& a, const TDynamicMatrix<U>& b, F f)
+        -> TDynamicMatrix<typename std::decay<decltype(f(a[0].data()[0], b[0].data()[0]))>::type>
+    {
+        typedef typename std::decay<decltype(f(a[0].data()[0], b[0].data()[0]))>::type R;
+        if (a.size() != b.size())
+            throw std::invalid_argument("Matrix sizes should be equal");
+        size_t n = a.size();
+        TDynamicMatrix<R> res(n);
+        for_rows(n, [&](size_t r0, size_t r1) {
+            for (size_t i = r0; i < r1; i++) {
+                const T* pa = a[i].data();
+                const U* pb = b[i].data();
+                R* pr = res[i].data();
+                for (size_t j = 0; j < n; j++)
+                    pr[j] = f(pa[j], pb[j]);
+            }
+        });
+        return res;
+    }
+
+    // Свертка op(...op(identity, x0)..., xn); op должна быть ассоциативной,
+    // identity - ее нейтральным элементом
+    template<typename T, typename Op>
+    static T reduce(const TDynamicVector<T>& v, T identity, Op op)
+    {
+        return fold(v.data(), v.size(), identity, [](const T& x) { return x; }, op);
+    }
+    // map и reduce за один проход, без промежуточного вектора
+    template<typename T, typename A, typename M, typename Op>
+    static A map_reduce(const TDynamicVector<T>& v, A identity, M m, Op op)
+    {
+        return fold(v.data(), v.size(), identity, m, op);
+    }
+    template<typename T, typename Op>
+    static T reduce(const TDynamicMatrix<T>& m, T identity, Op op)
+    {
+        return map_reduce(m, identity, [](const T& x) { return x; }, op);
+    }
+    template<typename T, typename A, typename M, typename Op>
+    static A map_reduce(const TDynamicMatrix<T>& m, A identity, M f, Op op)
+    {
+        size_t n = m.size();
+        std::vector<A> part(n, identity);
+        for_rows(n, [&](size_t r0, size_t r1) {
+            for (size_t i = r0; i < r1; i++) {
+                const T* p = m[i].data();
+                A acc = identity;
+                for (size_t j = 0; j < n; j++)
+                    acc = op(acc, f(p[j]));
+                part[i] = acc;
+            }
+        });
+        A res = identity;
+        for (size_t i = 0; i < n; i++)
+            res = op(res, part[i]);
+        return res;
+    }
+};
+
+// Произведение Адамара (поэлементное)
+template<typename T>
+TDynamicVector<T> hadamard(const TDynamicVector<T>& a, const TDynamicVector<T>& b)
+{
+    return TElementwise::zip(a, b, [](const T& x, const T& y) { return x * y; });
+}
+template<typename T>
+TDynamicMatrix<T> hadamard(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+    return TElementwise::zip(a, b, [](const T& x, const T& y) { return x * y; });
+}
+
+// Произведение Кронекера в заранее выделенную матрицу размера a.size() * b.size():
+// строка (i, k) результата - это подряд записанные блоки a[i][j] * b[k]
+template<typename T>
+void kronecker(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& res)
+{
+    size_t n = a.size(), m = b.size();
+    if (res.size() != n * m)
+        throw std::invalid_argument("Result size should be the product of the factor sizes");
+    auto body = [&](size_t r0, size_t r1) {
+        for (size_t r = r0; r < r1; r++) {
+            const T* pa = a[r / m].data();
+            const T* pb = b[r % m].data();
+            T* pr = res[r].data();
+            for (size_t j = 0; j < n; j++) {
+                const T aij = pa[j];
+                T* blk = pr + j * m;
+                for (size_t l = 0; l < m; l++)
+                    blk[l] = aij * pb[l];
+            }
+        }
+    };
+    if (TParallelConfig::use_parallel(n * m * n * m))
+        parallel_for(0, n * m, 1, body);
+    else
+        body(0, n * m);
+}
+template<typename T>
+TDynamicMatrix<T> kronecker(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+    TDynamicMatrix<T> res(a.size() * b.size());
+    kronecker(a, b, res);
+    return res;
+}
+template<typename T>
+TDynamicVector<T> kronecker(const TDynamicVector<T>& a, const TDynamicVector<T>& b)
+{
+    size_t n = a.size(), m = b.size();
+    TDynamicVector<T> res(n * m);
+    const T* pa = a.data();
+    const T* pb = b.data();
+    T* pr = res.data();
+    for (size_t i = 0; i < n; i++)
+        for (size_t l = 0; l < m; l++)
+            pr[i * m + l] = pa[i] * pb[l];
+    return res;
+}
+
+#endif
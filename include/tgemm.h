@@ -0,0 +1,537 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Ядра умножения матриц: блочное умножение и алгоритм Штрассена-Винограда
+
+#ifndef __TGemm_H__
+#define __TGemm_H__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+#include "taccumulate.h"
+#include "tparallel.h"
+#include "tperfcounters.h"
+#include "ttuningcache.h"
+
+// Представление квадратного блока матрицы -
+// массив указателей на строки и смещение по столбцам
+template<typename T>
+struct TMatrixView
+{
+    T* const* rows;
+    size_t col;
+
+    T* row(size_t i) const noexcept { return rows[i] + col; }
+    TMatrixView sub(size_t r, size_t c) const noexcept { return { rows + r, col + c }; }
+    operator TMatrixView<const T>() const noexcept
+    {
+        return { const_cast<const T* const*>(rows), col };
+    }
+};
+
+// Непрерывный буфер n x n с массивом указателей на строки
+template<typename T>
+class TMatrixBuffer
+{
+    std::vector<T> data;
+    std::vector<T*> ptrs;
+public:
+    explicit TMatrixBuffer(size_t n = 0) : data(n * n), ptrs(n)
+    {
+        for (size_t i = 0; i < n; i++)
+            ptrs[i] = data.data() + i * n;
+    }
+    TMatrixView<T> view() noexcept { return { ptrs.data(), 0 }; }
+};
+
+// Параметры для T: при первом обращении берутся из кэша настроек на диске
+// (TTuningCache::stored), если там есть запись для этого процессора и типа.
+// params() - ссылка без синхронизации, как и остальные настройки библиотеки:
+// менять параметры через нее можно, только пока умножения не выполняются.
+// Умножение берет копию через snapshot(), а publish() заменяет параметры под
+// той же блокировкой - так TAutoTuner::tune работает одновременно с умножениями
+template<typename T>
+struct TGemmConfig
+{
+    static TGemmParams& params()
+    {
+        static TGemmParams p = TTuningCache::stored<T>();
+        return p;
+    }
+    static std::mutex& lock()
+    {
+        static std::mutex m;
+        return m;
+    }
+    static TGemmParams snapshot()
+    {
+        std::lock_guard<std::mutex> lk(lock());
+        return params();
+    }
+    static void publish(const TGemmParams& p)
+    {
+        std::lock_guard<std::mutex> lk(lock());
+        params() = p;
+    }
+};
+
+// Специальное ядро умножения для типа элементов (например, вычеты по модулю):
+// специализация с custom = true и static multiply(a, b, c, n) заменяет общий выбор алгоритма
+template<typename T>
+struct TGemmKernel
+{
+    static constexpr bool custom = false;
+};
+
+// Полукольца для обобщенного умножения: C_ij = add_k mul(A_ik, B_kj).
+// zero() - нейтральный элемент сложения, one() - умножения
+
+// обычные сложение и умножение
+template<typename T>
+struct TPlusTimes
+{
+    static T zero() { return T(); }
+    static T one() { return T(1); }
+    static T add(T a, T b) { return a + b; }
+    static T mul(T a, T b) { return a * b; }
+};
+
+// "бесконечность" для тропических полуколец: у целых - половина диапазона,
+// чтобы сумма двух бесконечностей не переполнялась
+template<typename T>
+struct TTropicalInf
+{
+    static T value()
+    {
+        return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity()
+            : std::numeric_limits<T>::max() / 2;
+    }
+};
+
+// (min, +) - кратчайшие пути. Бесконечность поглощает любой вес, в том
+// числе отрицательный; у целых сумма насыщается вместо переполнения
+template<typename T>
+struct TMinPlus
+{
+    static T zero() { return TTropicalInf<T>::value(); }
+    static T one() { return T(); }
+    static T add(T a, T b) { return b < a ? b : a; }
+    static T mul(T a, T b)
+    {
+        if (!(a < zero()) || !(b < zero()))
+            return zero();
+        if constexpr (std::is_integral<T>::value)
+            if (b < T() && a < std::numeric_limits<T>::lowest() - b)
+                return std::numeric_limits<T>::lowest();
+        T s = a + b;
+        return s < zero() ? s : zero();
+    }
+};
+
+// (max, +) - самые длинные (критические) пути; минус бесконечность
+// поглощает любой вес, у целых сумма насыщается
+template<typename T>
+struct TMaxPlus
+{
+    static T zero() { return -TTropicalInf<T>::value(); }
+    static T one() { return T(); }
+    static T add(T a, T b) { return b > a ? b : a; }
+    static T mul(T a, T b)
+    {
+        if (!(a > zero()) || !(b > zero()))
+            return zero();
+        if constexpr (std::is_integral<T>::value)
+            if (b > T() && a > std::numeric_limits<T>::max() - b)
+                return std::numeric_limits<T>::max();
+        T s = a + b;
+        return s > zero() ? s : zero();
+    }
+};
+
+// (or, and) - достижимость, ненулевые элементы считаются истиной
+template<typename T>
+struct TOrAnd
+{
+    static T zero() { return T(); }
+    static T one() { return T(1); }
+    static T add(T a, T b) { return (a != T() || b != T()) ? T(1) : T(); }
+    static T mul(T a, T b) { return (a != T() && b != T()) ? T(1) : T(); }
+};
+
+// Умножение матриц C = A * B размера n x n
+template<typename T>
+class TGemm
+{
+    typedef TMatrixView<const T> CView;
+    typedef TMatrixView<T> View;
+
+    static double& last_error_ref()
+    {
+        static thread_local double e = 0.0;
+        return e;
+    }
+
+    static void add(View c, CView a, CView b, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) {
+            T* pc = c.row(i);
+            const T* pa = a.row(i);
+            const T* pb = b.row(i);
+            for (size_t j = 0; j < n; j++)
+                pc[j] = pa[j] + pb[j];
+        }
+    }
+    static void sub(View c, CView a, CView b, size_t n)
+    {
+        for (size_t i = 0; i < n; i++) {
+            T* pc = c.row(i);
+            const T* pa = a.row(i);
+            const T* pb = b.row(i);
+            for (size_t j = 0; j < n; j++)
+                pc[j] = pa[j] - pb[j];
+        }
+    }
+
+    // блоки строк [r0, r1) результата; C должна быть заполнена S::zero()
+    template<typename S = TPlusTimes<T>>
+    static void blocked_rows(CView a, CView b, View c, size_t n, size_t r0, size_t r1, size_t bs)
+    {
+        for (size_t ii = r0; ii < r1; ii += bs) {
+            size_t ie = std::min(ii + bs, r1);
+            for (size_t kk = 0; kk < n; kk += bs) {
+                size_t ke = std::min(kk + bs, n);
+                for (size_t jj = 0; jj < n; jj += bs) {
+                    size_t je = std::min(jj + bs, n);
+                    for (size_t i = ii; i < ie; i++) {
+                        T* pc = c.row(i);
+                        const T* pa = a.row(i);
+                        for (size_t k = kk; k < ke; k++) {
+                            const T aik = pa[k];
+                            const T* pb = b.row(k);
+                            for (size_t j = jj; j < je; j++)
+                                pc[j] = S::add(pc[j], S::mul(aik, pb[j]));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Штрассен-Виноград с двумя временными блоками на уровень рекурсии
+    // (схема Дугласа и др.), ws[level] - рабочая память уровня
+    static void strassen_seq(CView a, CView b, View c, size_t n, const TGemmParams& p,
+        std::vector<TMatrixBuffer<T>>& ws, size_t level)
+    {
+        if (n <= p.strassen_cutoff || n < 2) {
+            blocked(a, b, c, n, p);
+            return;
+        }
+        if (n % 2) {
+            strassen_peel(a, b, c, n, p, ws, level);
+            return;
+        }
+        size_t h = n / 2;
+        CView a11 = a, a12 = a.sub(0, h), a21 = a.sub(h, 0), a22 = a.sub(h, h);
+        CView b11 = b, b12 = b.sub(0, h), b21 = b.sub(h, 0), b22 = b.sub(h, h);
+        View c11 = c, c12 = c.sub(0, h), c21 = c.sub(h, 0), c22 = c.sub(h, h);
+        View x = ws[2 * level].view(), y = ws[2 * level + 1].view();
+
+        sub(x, a11, a21, h);                           // S3
+        sub(y, b22, b12, h);                           // T3
+        strassen_seq(x, y, c21, h, p, ws, level + 1);  // P7
+        add(x, a21, a22, h);                           // S1
+        sub(y, b12, b11, h);                           // T1
+        strassen_seq(x, y, c22, h, p, ws, level + 1);  // P5
+        sub(x, x, a11, h);                             // S2
+        sub(y, b22, y, h);                             // T2
+        strassen_seq(x, y, c12, h, p, ws, level + 1);  // P6
+        sub(x, a12, x, h);                             // S4
+        strassen_seq(x, b22, c11, h, p, ws, level + 1); // P3
+        strassen_seq(a11, b11, x, h, p, ws, level + 1); // P1
+        add(c12, x, c12, h);                           // U2 = P1 + P6
+        add(c21, c12, c21, h);                         // U3 = U2 + P7
+        add(c12, c12, c22, h);                         // U4 = U2 + P5
+        add(c22, c21, c22, h);                         // C22 = U3 + P5
+        add(c12, c12, c11, h);                         // C12 = U4 + P3
+        sub(y, y, b21, h);                             // T4
+        strassen_seq(a22, y, c11, h, p, ws, level + 1); // P4
+        sub(c21, c21, c11, h);                         // C21 = U3 - P4
+        strassen_seq(a12, b21, c11, h, p, ws, level + 1); // P2
+        add(c11, x, c11, h);                           // C11 = P1 + P2
+    }
+
+    // нечетный размер: Штрассен на (n-1) x (n-1), последние строка и столбец досчитываются
+    static void strassen_peel(CView a, CView b, View c, size_t n, const TGemmParams& p,
+        std::vector<TMatrixBuffer<T>>& ws, size_t level)
+    {
+        size_t m = n - 1;
+        strassen_seq(a, b, c, m, p, ws, level + 1);
+        fix_border(a, b, c, n);
+    }
+
+    static void fix_border(CView a, CView b, View c, size_t n)
+    {
+        size_t m = n - 1;
+        const T* bm = b.row(m);
+        for (size_t i = 0; i < m; i++) {
+            T* pc = c.row(i);
+            const T aim = a.row(i)[m];
+            for (size_t j = 0; j < m; j++)
+                pc[j] += aim * bm[j];
+        }
+        for (size_t i = 0; i < m; i++) {
+            const T* pa = a.row(i);
+            T s = T();
+            for (size_t k = 0; k < n; k++)
+                s += pa[k] * b.row(k)[m];
+            c.row(i)[m] = s;
+        }
+        T* pc = c.row(m);
+        const T* pa = a.row(m);
+        for (size_t j = 0; j < n; j++)
+            pc[j] = T();
+        for (size_t k = 0; k < n; k++) {
+            const T amk = pa[k];
+            const T* pb = b.row(k);
+            for (size_t j = 0; j < n; j++)
+                pc[j] += amk * pb[j];
+        }
+    }
+
+    // рабочая память для последовательной рекурсии начиная с размера n
+    static std::vector<TMatrixBuffer<T>> workspace(size_t n, const TGemmParams& p)
+    {
+        std::vector<TMatrixBuffer<T>> ws;
+        while (n > p.strassen_cutoff && n >= 2) {
+            if (n % 2) {
+                ws.emplace_back();
+                ws.emplace_back();
+                n--;
+                continue;
+            }
+            n /= 2;
+            ws.emplace_back(n);
+            ws.emplace_back(n);
+        }
+        return ws;
+    }
+
+    // верхний уровень: семь произведений вычисляются параллельно
+    static void strassen_par(CView a, CView b, View c, size_t n, const TGemmParams& p)
+    {
+        if (n % 2) {
+            strassen_par(a, b, c, n - 1, p);
+            fix_border(a, b, c, n);
+            return;
+        }
+        size_t h = n / 2;
+        CView a11 = a, a12 = a.sub(0, h), a21 = a.sub(h, 0), a22 = a.sub(h, h);
+        CView b11 = b, b12 = b.sub(0, h), b21 = b.sub(h, 0), b22 = b.sub(h, h);
+        View c11 = c, c12 = c.sub(0, h), c21 = c.sub(h, 0), c22 = c.sub(h, h);
+
+        TMatrixBuffer<T> s1(h), s2(h), s3(h), s4(h), t1(h), t2(h), t3(h), t4(h);
+        add(s1.view(), a21, a22, h);
+        sub(s2.view(), s1.view(), a11, h);
+        sub(s3.view(), a11, a21, h);
+        sub(s4.view(), a12, s2.view(), h);
+        sub(t1.view(), b12, b11, h);
+        sub(t2.view(), b22, t1.view(), h);
+        sub(t3.view(), b22, b12, h);
+        sub(t4.view(), t2.view(), b21, h);
+
+        // P1 и P2 пишутся прямо в C11 и C12, остальные - во временные блоки
+        TMatrixBuffer<T> p3(h), p4(h), p5(h), p6(h), p7(h);
+        CView lhs[7] = { a11, a12, s4.view(), a22, s1.view(), s2.view(), s3.view() };
+        CView rhs[7] = { b11, b21, b22, t4.view(), t1.view(), t2.view(), t3.view() };
+        View dst[7] = { c11, c12, p3.view(), p4.view(), p5.view(), p6.view(), p7.view() };
+        TTaskGroup group;
+        for (int t = 1; t < 7; t++)
+            group.run([&, t]() {
+                std::vector<TMatrixBuffer<T>> ws = workspace(h, p);
+                strassen_seq(lhs[t], rhs[t], dst[t], h, p, ws, 0);
+            });
+        {
+            std::vector<TMatrixBuffer<T>> ws = workspace(h, p);
+            strassen_seq(lhs[0], rhs[0], dst[0], h, p, ws, 0);
+        }
+        group.wait();
+
+        // U2 = P1 + P6 -> C21, U3 = U2 + P7, U4 = U2 + P5
+        add(c21, c11, p6.view(), h);
+        add(p6.view(), c21, p7.view(), h);  // U3
+        add(c21, c21, p5.view(), h);        // U4
+        add(c11, c11, c12, h);              // C11 = P1 + P2
+        add(c12, c21, p3.view(), h);        // C12 = U4 + P3
+        sub(c21, p6.view(), p4.view(), h);  // C21 = U3 - P4
+        add(c22, p6.view(), p5.view(), h);  // C22 = U3 + P5
+    }
+
+    static void fill(View c, size_t n, T val)
+    {
+        for (size_t i = 0; i < n; i++)
+            std::fill(c.row(i), c.row(i) + n, val);
+    }
+public:
+    // блочное умножение над полукольцом S (по умолчанию - обычное)
+    template<typename S = TPlusTimes<T>>
+    static void blocked(CView a, CView b, View c, size_t n, const TGemmParams& p)
+    {
+        fill(c, n, S::zero());
+        size_t bs = p.block_size ? p.block_size : n;
+        if (n < p.parallel_threshold) {
+            blocked_rows<S>(a, b, c, n, 0, n, bs);
+            return;
+        }
+        parallel_for(0, (n + bs - 1) / bs, 1, [&](size_t b0, size_t b1) {
+            blocked_rows<S>(a, b, c, n, b0 * bs, std::min(b1 * bs, n), bs);
+        });
+    }
+
+    // Штрассен-Виноград, при n <= strassen_cutoff - блочное умножение
+    static void strassen(CView a, CView b, View c, size_t n, const TGemmParams& p)
+    {
+        if (n <= p.strassen_cutoff || n < 2)
+            blocked(a, b, c, n, p);
+        else
+            strassen_par(a, b, c, n, p);
+        if (std::is_floating_point<T>::value && p.precision_check) {
+            double tol = p.tolerance > 0 ? p.tolerance : std::sqrt((double)std::numeric_limits<T>::epsilon());
+            double err = residual(a, b, c, n);
+            last_error_ref() = err;
+            if (err > tol)
+                blocked(a, b, c, n, p);
+        }
+    }
+
+    // Блочное умножение для типов хранения пониженной точности:
+    // блоки A и B расширяются в буферы типа вычислений, строки C
+    // накапливаются в нем же и сужаются один раз при записи
+    static void widened(CView a, CView b, View c, size_t n, const TGemmParams& p)
+    {
+        typedef typename TComputeType<T>::type C;
+        size_t bs = p.block_size ? p.block_size : n;
+        auto rows = [&](size_t b0, size_t b1) {
+            std::vector<C> abuf(bs * bs), bbuf(bs * bs), cbuf(bs * n);
+            for (size_t ib = b0; ib < b1; ib++) {
+                size_t ii = ib * bs, ie = std::min(ii + bs, n);
+                std::fill(cbuf.begin(), cbuf.end(), C());
+                for (size_t kk = 0; kk < n; kk += bs) {
+                    size_t kw = std::min(kk + bs, n) - kk;
+                    for (size_t i = ii; i < ie; i++)
+                        TConvert<T, C>::run(a.row(i) + kk, &abuf[(i - ii) * bs], kw);
+                    for (size_t jj = 0; jj < n; jj += bs) {
+                        size_t jw = std::min(jj + bs, n) - jj;
+                        for (size_t k = 0; k < kw; k++)
+                            TConvert<T, C>::run(b.row(kk + k) + jj, &bbuf[k * bs], jw);
+                        for (size_t i = 0; i < ie - ii; i++) {
+                            C* pc = &cbuf[i * n + jj];
+                            for (size_t k = 0; k < kw; k++) {
+                                const C aik = abuf[i * bs + k];
+                                const C* pb = &bbuf[k * bs];
+                                for (size_t j = 0; j < jw; j++)
+                                    pc[j] += aik * pb[j];
+                            }
+                        }
+                    }
+                }
+                for (size_t i = ii; i < ie; i++)
+                    TConvert<C, T>::run(&cbuf[(i - ii) * n], c.row(i), n);
+            }
+        };
+        size_t blocks = (n + bs - 1) / bs;
+        if (n < p.parallel_threshold)
+            rows(0, blocks);
+        else
+            parallel_for(0, blocks, 1, rows);
+    }
+
+    // умножение через скалярные произведения строк A и строк B^T
+    // с заданной политикой суммирования; B транспонируется один раз
+    static void dot_product(CView a, CView b, View c, size_t n, TSumPolicy policy, const TGemmParams& p)
+    {
+        TMatrixBuffer<T> bt(n);
+        View t = bt.view();
+        for (size_t k = 0; k < n; k++) {
+            const T* pb = b.row(k);
+            for (size_t j = 0; j < n; j++)
+                t.row(j)[k] = pb[j];
+        }
+        size_t bs = p.block_size ? p.block_size : n;
+        auto rows = [&](size_t r0, size_t r1) {
+            for (size_t jj = 0; jj < n; jj += bs) {
+                size_t je = std::min(jj + bs, n);
+                for (size_t i = r0; i < r1; i++)
+                    for (size_t j = jj; j < je; j++)
+                        c.row(i)[j] = TAccumulate<T>::dot(a.row(i), t.row(j), n, policy);
+            }
+        };
+        if (n < p.parallel_threshold)
+            rows(0, n);
+        else
+            parallel_for(0, n, bs, rows);
+    }
+
+    // выбор алгоритма по размеру и политике суммирования
+    static void multiply(CView a, CView b, View c, size_t n, TSumPolicy policy)
+    {
+        TMATRIX_PERF_SCOPE("gemm");
+        TMATRIX_TRACE_SCOPE("gemm");
+        const TGemmParams p = TGemmConfig<T>::snapshot();
+        if constexpr (TGemmKernel<T>::custom)
+            TGemmKernel<T>::multiply(a, b, c, n);
+        else if constexpr (!std::is_same<typename TComputeType<T>::type, T>::value)
+            widened(a, b, c, n, p);
+        else if (policy != TSumPolicy::naive && std::is_floating_point<T>::value)
+            dot_product(a, b, c, n, policy, p);
+        else if (n >= p.strassen_threshold)
+            strassen(a, b, c, n, p);
+        else
+            blocked(a, b, c, n, p);
+    }
+    static void multiply(CView a, CView b, View c, size_t n)
+    {
+        multiply(a, b, c, n, TSumConfig<T>::policy());
+    }
+
+    // ошибка последней проверки точности в текущем потоке
+    static double last_error() { return last_error_ref(); }
+
+    // нормированная ошибка ||C r - A (B r)|| / (||A|| ||B|| ||r||) - то, что
+    // сравнивает с tolerance проверка точности после Штрассена
+    static double residual(CView a, CView b, CView c, size_t n)
+    {
+        std::vector<long double> r(n), br(n);
+        unsigned s = 12345u;
+        for (size_t i = 0; i < n; i++) {
+            s = s * 1103515245u + 12345u;
+            r[i] = (long double)((s >> 8) & 0xFFFF) / 65536.0L + 0.5L;
+        }
+        long double na = 0, nb = 0, diff = 0;
+        for (size_t i = 0; i < n; i++) {
+            long double sb = 0, rowa = 0, rowb = 0;
+            for (size_t k = 0; k < n; k++) {
+                sb += (long double)b.row(i)[k] * r[k];
+                rowa += std::fabs((long double)a.row(i)[k]);
+                rowb += std::fabs((long double)b.row(i)[k]);
+            }
+            br[i] = sb;
+            na = std::max(na, rowa);
+            nb = std::max(nb, rowb);
+        }
+        for (size_t i = 0; i < n; i++) {
+            long double cr = 0, abr = 0;
+            for (size_t k = 0; k < n; k++) {
+                cr += (long double)c.row(i)[k] * r[k];
+                abr += (long double)a.row(i)[k] * br[k];
+            }
+            diff = std::max(diff, std::fabs(cr - abr));
+        }
+        long double scale = na * nb * 1.5L;
+        return scale > 0 ? (double)(diff / scale) : 0.0;
+    }
+};
+
+#endif
@@ -0,0 +1,212 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Типы половинной точности (IEEE half и bfloat16) для хранения матриц
+
+#ifndef __THalf_H__
+#define __THalf_H__
+
+#include <cstdint>
+#include <cstring>
+#include "tmatrix.h"
+
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+// Побитовые преобразования float <-> 16-битные форматы
+struct THalfBits
+{
+    static uint32_t as_uint(float f) noexcept
+    {
+        uint32_t x;
+        std::memcpy(&x, &f, sizeof(x));
+        return x;
+    }
+    static float as_float(uint32_t x) noexcept
+    {
+        float f;
+        std::memcpy(&f, &x, sizeof(f));
+        return f;
+    }
+
+    // float -> half с округлением к ближайшему четному
+    static uint16_t float_to_half(float f) noexcept
+    {
+        uint32_t x = as_uint(f);
+        uint32_t sign = x & 0x80000000u;
+        x ^= sign;
+        uint16_t h;
+        if (x >= 0x47800000u)                       // 65536 и больше, Inf, NaN
+            h = x > 0x7f800000u ? 0x7e00 : 0x7c00;
+        else if (x < 0x38800000u) {                 // денормализованные половинки
+            const uint32_t magic = 0x3f000000u;     // 0.5f сдвигает мантиссу на место
+            h = (uint16_t)(as_uint(as_float(x) + as_float(magic)) - magic);
+        }
+        else {
+            uint32_t odd = (x >> 13) & 1;
+            x += 0xc8000fffu + odd;                 // смена смещения порядка и округление
+            h = (uint16_t)(x >> 13);
+        }
+        return (uint16_t)(h | (sign >> 16));
+    }
+    static float half_to_float(uint16_t h) noexcept
+    {
+        const uint32_t exp_mask = 0x7c00u << 13;
+        uint32_t o = (uint32_t)(h & 0x7fff) << 13;
+        uint32_t exp = o & exp_mask;
+        o += (127 - 15) << 23;
+        if (exp == exp_mask)                        // Inf, NaN
+            o += (128 - 16) << 23;
+        else if (exp == 0) {                        // ноль и денормализованные
+            o += 1 << 23;
+            o = as_uint(as_float(o) - as_float(113u << 23));
+        }
+        return as_float(o | ((uint32_t)(h & 0x8000) << 16));
+    }
+
+    // float -> bfloat16 (старшие 16 бит) с округлением к ближайшему четному
+    static uint16_t float_to_bf16(float f) noexcept
+    {
+        uint32_t x = as_uint(f);
+        if ((x & 0x7fffffffu) > 0x7f800000u)
+            return (uint16_t)((x >> 16) | 0x40);    // тихий NaN
+        x += 0x7fffu + ((x >> 16) & 1);
+        return (uint16_t)(x >> 16);
+    }
+    static float bf16_to_float(uint16_t b) noexcept
+    {
+        return as_float((uint32_t)b << 16);
+    }
+};
+
+// Общая часть 16-битных типов: хранение и арифметика через float
+template<typename Derived>
+struct TFloat16Base
+{
+    uint16_t bits;
+
+    static Derived from_bits(uint16_t b) noexcept
+    {
+        Derived r;
+        r.bits = b;
+        return r;
+    }
+
+    friend Derived operator+(Derived a, Derived b) { return Derived(float(a) + float(b)); }
+    friend Derived operator-(Derived a, Derived b) { return Derived(float(a) - float(b)); }
+    friend Derived operator*(Derived a, Derived b) { return Derived(float(a) * float(b)); }
+    friend Derived operator/(Derived a, Derived b) { return Derived(float(a) / float(b)); }
+    friend Derived operator-(Derived a) { return Derived(-float(a)); }
+    friend Derived& operator+=(Derived& a, Derived b) { return a = a + b; }
+    friend Derived& operator-=(Derived& a, Derived b) { return a = a - b; }
+    friend Derived& operator*=(Derived& a, Derived b) { return a = a * b; }
+    friend Derived& operator/=(Derived& a, Derived b) { return a = a / b; }
+
+    friend bool operator==(Derived a, Derived b) { return float(a) == float(b); }
+    friend bool operator!=(Derived a, Derived b) { return float(a) != float(b); }
+    friend bool operator<(Derived a, Derived b) { return float(a) < float(b); }
+    friend bool operator>(Derived a, Derived b) { return float(a) > float(b); }
+    friend bool operator<=(Derived a, Derived b) { return float(a) <= float(b); }
+    friend bool operator>=(Derived a, Derived b) { return float(a) >= float(b); }
+
+    friend istream& operator>>(istream& istr, Derived& v)
+    {
+        float f;
+        if (istr >> f)
+            v = Derived(f);
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, Derived v)
+    {
+        return ostr << float(v);
+    }
+};
+
+// IEEE 754 binary16: 5 бит порядка, 10 бит мантиссы
+struct THalf : TFloat16Base<THalf>
+{
+    THalf() = default;
+    THalf(float f) noexcept { bits = THalfBits::float_to_half(f); }
+    THalf(double d) noexcept : THalf((float)d) {}
+    THalf(int i) noexcept : THalf((float)i) {}
+    operator float() const noexcept { return THalfBits::half_to_float(bits); }
+};
+
+// bfloat16: порядок как у float, 7 бит мантиссы
+struct TBFloat16 : TFloat16Base<TBFloat16>
+{
+    TBFloat16() = default;
+    TBFloat16(float f) noexcept { bits = THalfBits::float_to_bf16(f); }
+    TBFloat16(double d) noexcept : TBFloat16((float)d) {}
+    TBFloat16(int i) noexcept : TBFloat16((float)i) {}
+    operator float() const noexcept { return THalfBits::bf16_to_float(bits); }
+};
+
+// вычисления ведутся во float
+template<>
+struct TComputeType<THalf> { typedef float type; };
+template<>
+struct TComputeType<TBFloat16> { typedef float type; };
+
+template<>
+struct TTuningTag<THalf>
+{
+    static std::string name() { return "half"; }
+};
+template<>
+struct TTuningTag<TBFloat16>
+{
+    static std::string name() { return "bfloat16"; }
+};
+
+// Пакетные преобразования: F16C при наличии, иначе скалярный цикл
+template<>
+struct TConvert<THalf, float>
+{
+    static void run(const THalf* src, float* dst, size_t n)
+    {
+        size_t i = 0;
+#if defined(__F16C__)
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)(src + i))));
+#endif
+        for (; i < n; i++)
+            dst[i] = THalfBits::half_to_float(src[i].bits);
+    }
+};
+template<>
+struct TConvert<float, THalf>
+{
+    static void run(const float* src, THalf* dst, size_t n)
+    {
+        size_t i = 0;
+#if defined(__F16C__)
+        for (; i + 8 <= n; i += 8)
+            _mm_storeu_si128((__m128i*)(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+        for (; i < n; i++)
+            dst[i].bits = THalfBits::float_to_half(src[i]);
+    }
+};
+
+// bfloat16 - сдвиги и сложения, цикл векторизуется компилятором
+template<>
+struct TConvert<TBFloat16, float>
+{
+    static void run(const TBFloat16* src, float* dst, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+            dst[i] = THalfBits::bf16_to_float(src[i].bits);
+    }
+};
+template<>
+struct TConvert<float, TBFloat16>
+{
+    static void run(const float* src, TBFloat16* dst, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+            dst[i].bits = THalfBits::float_to_bf16(src[i]);
+    }
+};
+
+#endif
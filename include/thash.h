@@ -0,0 +1,159 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Хеш содержимого векторов и матриц (потоковый XXH64)
+
+#ifndef __THash_H__
+#define __THash_H__
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "tmatrix.h"
+
+// Потоковый 64-битный хеш по алгоритму xxHash64: четыре независимые полосы
+// по 8 байт, обрабатываются блоки по 32 байта. Результат совпадает с XXH64
+class THasher
+{
+    static constexpr uint64_t P1 = 0x9E3779B185EBCA87ull;
+    static constexpr uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr uint64_t P3 = 0x165667B19E3779F9ull;
+    static constexpr uint64_t P4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr uint64_t P5 = 0x27D4EB2F165667C5ull;
+
+    uint64_t acc[4];
+    uint64_t seed;
+    uint64_t total;
+    unsigned char buf[32];
+    size_t used;
+
+    static uint64_t rotl(uint64_t x, int r) noexcept { return (x << r) | (x >> (64 - r)); }
+    static uint64_t read64(const unsigned char* p) noexcept
+    {
+        uint64_t x;
+        std::memcpy(&x, p, 8);
+        return x;
+    }
+    static uint32_t read32(const unsigned char* p) noexcept
+    {
+        uint32_t x;
+        std::memcpy(&x, p, 4);
+        return x;
+    }
+    static uint64_t round(uint64_t a, uint64_t x) noexcept
+    {
+        a += x * P2;
+        a = rotl(a, 31);
+        return a * P1;
+    }
+    static uint64_t merge(uint64_t h, uint64_t a) noexcept
+    {
+        h ^= round(0, a);
+        return h * P1 + P4;
+    }
+    void stripe(const unsigned char* p) noexcept
+    {
+        acc[0] = round(acc[0], read64(p));
+        acc[1] = round(acc[1], read64(p + 8));
+        acc[2] = round(acc[2], read64(p + 16));
+        acc[3] = round(acc[3], read64(p + 24));
+    }
+public:
+    explicit THasher(uint64_t s = 0) noexcept { reset(s); }
+
+    void reset(uint64_t s = 0) noexcept
+    {
+        seed = s;
+        acc[0] = s + P1 + P2;
+        acc[1] = s + P2;
+        acc[2] = s;
+        acc[3] = s - P1;
+        total = 0;
+        used = 0;
+    }
+
+    void update(const void* data, size_t len) noexcept
+    {
+        const unsigned char* p = static_cast<const unsigned char*>(data);
+        total += len;
+        if (used) {
+            size_t take = std::min(len, 32 - used);
+            std::memcpy(buf + used, p, take);
+            used += take;
+            p += take;
+            len -= take;
+            if (used < 32)
+                return;
+            stripe(buf);
+            used = 0;
+        }
+        for (; len >= 32; p += 32, len -= 32)
+            stripe(p);
+        if (len) {
+            std::memcpy(buf, p, len);
+            used = len;
+        }
+    }
+
+    uint64_t digest() const noexcept
+    {
+        uint64_t h;
+        if (total >= 32) {
+            h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+            for (int i = 0; i < 4; i++)
+                h = merge(h, acc[i]);
+        }
+        else
+            h = seed + P5;
+        h += total;
+        const unsigned char* p = buf;
+        size_t len = used;
+        for (; len >= 8; p += 8, len -= 8) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * P1 + P4;
+        }
+        if (len >= 4) {
+            h ^= (uint64_t)read32(p) * P1;
+            h = rotl(h, 23) * P2 + P3;
+            p += 4;
+            len -= 4;
+        }
+        for (; len > 0; p++, len--) {
+            h ^= (*p) * P5;
+            h = rotl(h, 11) * P1;
+        }
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+};
+
+// Хеш содержимого: размер и байты элементов. Подходит для ключей кэша -
+// равные побитово объекты дают равные хеши (у вещественных -0.0 и 0.0 хеши разные)
+template<typename T>
+uint64_t content_hash(const TDynamicVector<T>& v, uint64_t seed = 0)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Elements should be trivially copyable");
+    THasher h(seed);
+    uint64_t n = v.size();
+    h.update(&n, sizeof(n));
+    h.update(v.data(), v.size() * sizeof(T));
+    return h.digest();
+}
+
+// строки матрицы лежат отдельно и подаются в хеш по очереди
+template<typename T>
+uint64_t content_hash(const TDynamicMatrix<T>& m, uint64_t seed = 0)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Elements should be trivially copyable");
+    THasher h(seed);
+    uint64_t n = m.size();
+    h.update(&n, sizeof(n));
+    for (size_t i = 0; i < m.size(); i++)
+        h.update(m[i].data(), m.size() * sizeof(T));
+    return h.digest();
+}
+
+#endif
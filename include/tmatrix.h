@@ -7,22 +7,174 @@
 #ifndef __TDynamicMatrix_H__
 #define __TDynamicMatrix_H__
 
+#include <cstring>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "tgemm.h"
+#include "tmetrics.h"
 
 using namespace std;
 
 const int MAX_VECTOR_SIZE = 100000000;
 const int MAX_MATRIX_SIZE = 10000;
 
+// Встроенный буфер для коротких векторов -
+// память под N элементов внутри самого объекта
+template<typename T, size_t N>
+struct TInlineStorage
+{
+    alignas(T) unsigned char raw[N * sizeof(T)];
+    T* ptr() noexcept { return reinterpret_cast<T*>(raw); }
+    const T* ptr() const noexcept { return reinterpret_cast<const T*>(raw); }
+};
+template<typename T>
+struct TInlineStorage<T, 0>
+{
+    T* ptr() noexcept { return nullptr; }
+    const T* ptr() const noexcept { return nullptr; }
+};
+
+// Емкость встроенного буфера: до 16 элементов, не больше 128 байт,
+// только для тривиальных типов - их можно копировать побайтно
+template<typename T>
+struct TInlineCapacity
+{
+    static constexpr size_t value = std::is_trivial<T>::value && sizeof(T) <= 128
+        ? (128 / sizeof(T) < 16 ? 128 / sizeof(T) : 16) : 0;
+};
+
+// Побитовое равенство совпадает с равенством значений: такие массивы
+// сравниваются через memcmp. Вещественные типы исключены (-0.0 == 0.0, NaN != NaN),
+// специализируется для типов с однозначным представлением
+template<typename T>
+struct TBitwiseEqual
+{
+    static constexpr bool value = std::is_integral<T>::value || std::is_enum<T>::value
+        || std::is_pointer<T>::value;
+};
+
 // Динамический вектор - 
 // шаблонный вектор на динамической памяти
 template<typename T>
 class TDynamicVector
 {
+public:
+    static constexpr size_t INLINE_CAPACITY = TInlineCapacity<T>::value;
 protected:
     size_t sz;
     T* pMem;
+    bool mapped = false;    // память - отдельное отображение TNuma::map_interleaved
+    TInlineStorage<T, INLINE_CAPACITY> inl;
+
+    // память под n элементов без создания объектов: короткие векторы - во
+    // встроенном буфере. При политике interleave массивы тривиальных типов
+    // от страницы и больше получают свое отображение: страницы кучи могли
+    // уже использоваться, и mbind их не переместит, а политика чередования
+    // осталась бы на участке кучи, который потом займут другие выделения
+    T* allocate(size_t n)
+    {
+        mapped = false;
+        if (n <= INLINE_CAPACITY)
+            return inl.ptr();
+        TMATRIX_METRIC_ALLOC(n * sizeof(T));
+        if constexpr (std::is_trivial<T>::value)
+            if (TNumaConfig::policy() == TNumaPolicy::interleave && n * sizeof(T) >= TNuma::PAGE)
+                if (void* p = TNuma::map_interleaved(n * sizeof(T))) {
+                    mapped = true;
+                    return static_cast<T*>(p);
+                }
+        return static_cast<T*>(::operator new(n * sizeof(T), storage_align(n)));
+    }
+    // большие массивы выровнены по странице: тогда куски for_chunks, кратные
+    // странице, не делят страницы и строки кэша между потоками
+    static std::align_val_t storage_align(size_t n) noexcept
+    {
+        return std::align_val_t(n * sizeof(T) >= 16 * TNuma::PAGE && alignof(T) <= TNuma::PAGE
+            ? TNuma::PAGE : alignof(T));
+    }
+    // первая запись в выделенную память: при политике first_touch большие
+    // массивы заполняются по кускам for_chunks теми же потоками, что потом
+    // обрабатывают эти куски в поэлементных операциях
+    template<typename F>
+    void first_touch(F&& f)
+    {
+        if constexpr (std::is_trivial<T>::value)
+            if (TNumaConfig::policy() == TNumaPolicy::first_touch && !is_inline()) {
+                for_chunks(f);
+                return;
+            }
+        f(size_t(0), sz);
+    }
+    void release(T* p) noexcept
+    {
+        if (mapped)
+            TNuma::unmap(p, sz * sizeof(T));
+        else if (p != inl.ptr())
+            ::operator delete(p, storage_align(sz));
+    }
+    void deallocate() noexcept
+    {
+        if (pMem)
+            std::destroy_n(pMem, sz);
+        release(pMem);
+    }
+    // создание элементов в только что выделенной памяти; если создание
+    // бросает исключение, созданные элементы уже разрушены и память освобождается
+    template<typename F>
+    void construct(F&& f)
+    {
+        try {
+            first_touch(f);
+        }
+        catch (...) {
+            release(pMem);
+            throw;
+        }
+    }
+    // перенос содержимого v, v остается пустым
+    void steal(TDynamicVector& v) noexcept
+    {
+        sz = v.sz;
+        mapped = v.mapped;
+        if (v.is_inline()) {
+            pMem = inl.ptr();
+            std::copy(v.pMem, v.pMem + sz, pMem);
+        }
+        else
+            pMem = v.pMem;
+        v.sz = 0;       // Обнуляем размер перемещаемого вектора
+        v.mapped = false;
+        v.pMem = nullptr; // Устанавливаем указатель на nullptr
+    }
+    // равенство n элементов, memcmp для побитово сравнимых типов
+    static bool equal_range(const T* a, const T* b, size_t n) noexcept
+    {
+        if constexpr (TBitwiseEqual<T>::value)
+            return n == 0 || std::memcmp(a, b, n * sizeof(T)) == 0;
+        else {
+            for (size_t i = 0; i < n; i++)
+                if (a[i] != b[i])
+                    return false;
+            return true;
+        }
+    }
+    // поэлементная обработка: большие векторы делятся между потоками
+    // кусками, выровненными по странице памяти. Страницы размещает поток,
+    // коснувшийся их первым: по умолчанию это поток, создавший вектор, а
+    // при политике first_touch - поток, который потом обрабатывает этот кусок
+    template<typename F>
+    void for_chunks(F&& f) const
+    {
+        if (TParallelConfig::use_parallel(sz))
+            parallel_for_aligned(sz, 4096 / sizeof(T) ? 4096 / sizeof(T) : 1, f);
+        else
+            f(size_t(0), sz);
+    }
 public:
+    static constexpr size_t DOT_BLOCK = 8192;
+
     // всякие конструкторы
     TDynamicVector(size_t size = 1) : sz(size)
     {
@@ -30,61 +182,69 @@ public:
             throw std::out_of_range("Vector size should be greater than zero");
         if (sz >= MAX_VECTOR_SIZE)
             throw std::out_of_range("Too large vector size");
-        pMem = new T[sz]();// У типа T д.б. конструктор по умолчанию
+        pMem = allocate(sz);
+        construct([this](size_t b, size_t e) {
+            std::uninitialized_value_construct_n(pMem + b, e - b); // У типа T д.б. конструктор по умолчанию
+        });
     }
-    TDynamicVector(T* arr, size_t s)
+    TDynamicVector(const T* arr, size_t s)
     {
         sz = s;
-        pMem = new T[sz];
-        std::copy(arr, arr + sz, pMem);
+        pMem = allocate(sz);
+        construct([this, arr](size_t b, size_t e) { std::uninitialized_copy(arr + b, arr + e, pMem + b); });
     }
     TDynamicVector(const TDynamicVector& v)
     {
         sz = v.sz;
-        pMem = new T[sz];
-        for (int i = 0; i < sz; i++)
-            pMem[i] = v.pMem[i];
+        pMem = allocate(sz);
+        construct([this, &v](size_t b, size_t e) {
+            std::uninitialized_copy(v.pMem + b, v.pMem + e, pMem + b);
+        });
     }
-    TDynamicVector(TDynamicVector&& v) noexcept : sz(v.sz), pMem(v.pMem)
+    TDynamicVector(TDynamicVector&& v) noexcept
     {
-        v.sz = 0;       // Обнуляем размер перемещаемого вектора
-        v.pMem = nullptr; // Устанавливаем указатель на nullptr
+        steal(v);
     }
     ~TDynamicVector()
     {
-        delete[]pMem;
+        deallocate();
     }
     //операторы разные
     TDynamicVector& operator=(const TDynamicVector& v)
     {
         if (this == &v)
             return *this;
-        if (sz != v.sz) {
-            T* p = new T[v.sz];
-            delete[] pMem;
-            sz = v.sz;
-            pMem = p;
-        }
-        for (int i = 0;i < sz;i++)
-            this->pMem[i] = v.pMem[i];
+        // другой размер: новые элементы создаются копированием
+        if (sz != v.sz)
+            return *this = TDynamicVector(v);
+        first_touch([this, &v](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                this->pMem[i] = v.pMem[i];
+        });
         return *this;
     }
 
     TDynamicVector& operator=(TDynamicVector&& v) noexcept
     {
         if (this != &v) {
-            delete[] pMem;
-            pMem = v.pMem;
-            sz = v.sz;
-            // Обнуляем перемещаемый объект
-            v.pMem = nullptr;
-            v.sz = 0;
+            deallocate();
+            steal(v);
         }
         return *this;
     }
 
+    // данные лежат во встроенном буфере
+    bool is_inline() const noexcept
+    {
+        return INLINE_CAPACITY > 0 && pMem == inl.ptr();
+    }
+
     size_t size() const noexcept { return sz; }
 
+    // непосредственный доступ к памяти для вычислительных ядер
+    T* data() noexcept { return pMem; }
+    const T* data() const noexcept { return pMem; }
+
     // индексация
     T& operator[](size_t index)
     {
@@ -122,10 +282,26 @@ public:
         if (sz != v.sz) {
             return false;
         }
-        for (size_t i = 0; i < sz; i++)
-            if (pMem[i] != v.pMem[i])
-                return false;
-        return true; // Если все элементы равны
+        if (!TParallelConfig::use_parallel(sz))
+            return equal_range(pMem, v.pMem, sz);
+        std::atomic<bool> equal(true);
+        try {
+            for_chunks([&](size_t b, size_t e) {
+                // куски проверяются порциями, чтобы рано остановиться при различии
+                for (size_t i = b; i < e && equal.load(std::memory_order_relaxed); i += 4096) {
+                    size_t end = std::min(e, i + 4096);
+                    if (!equal_range(pMem + i, v.pMem + i, end - i)) {
+                        equal.store(false, std::memory_order_relaxed);
+                        return;
+                    }
+                }
+            });
+        }
+        catch (...) {
+            // задачи не удалось запустить (нехватка памяти) - сравнение здесь
+            return equal_range(pMem, v.pMem, sz);
+        }
+        return equal.load();
     }
 
     bool operator!=(const TDynamicVector& v) const noexcept
@@ -134,61 +310,117 @@ public:
     }
 
     // скалярные операции
-    TDynamicVector operator+(T val)
+    TDynamicVector operator+(T val) const
     {
+        TMATRIX_METRIC_SCOPE(vector_scalar, sz, sz, 2 * sz * sizeof(T));
         TDynamicVector res(sz); // новый вектор для результатов
-        for (size_t i = 0; i < sz; i++)
-            res[i] = pMem[i] + val;
+        T* r = res.pMem;
+        for_chunks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                r[i] = pMem[i] + val;
+        });
         return res;
     }
-    TDynamicVector operator-(T val)
+    TDynamicVector operator-(T val) const
     {
+        TMATRIX_METRIC_SCOPE(vector_scalar, sz, sz, 2 * sz * sizeof(T));
         TDynamicVector res(sz);
-        for (size_t i = 0; i < sz; i++)
-            res[i] = pMem[i] - val;
+        T* r = res.pMem;
+        for_chunks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                r[i] = pMem[i] - val;
+        });
         return res;
     }
-    TDynamicVector operator*(T val)
+    TDynamicVector operator*(T val) const
     {
+        TMATRIX_METRIC_SCOPE(vector_scalar, sz, sz, 2 * sz * sizeof(T));
         TDynamicVector res(sz);
-        for (size_t i = 0; i < sz; i++)
-            res[i] = pMem[i] * val;
+        T* r = res.pMem;
+        for_chunks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                r[i] = pMem[i] * val;
+        });
         return res;
     }
 
     // векторные операции
-    TDynamicVector operator+(const TDynamicVector& v)
+    TDynamicVector operator+(const TDynamicVector& v) const
     {
         if (sz != v.sz)
             throw std::invalid_argument("Vectors must have the same size");
+        TMATRIX_METRIC_SCOPE(vector_add, sz, sz, 3 * sz * sizeof(T));
         TDynamicVector res(sz);
-        for (size_t i = 0; i < res.size(); i++)
-            res[i] = pMem[i] + v.pMem[i];
+        T* r = res.pMem;
+        const T* pv = v.pMem;
+        for_chunks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                r[i] = pMem[i] + pv[i];
+        });
         return res;
     }
-    TDynamicVector operator-(const TDynamicVector& v)
+    TDynamicVector operator-(const TDynamicVector& v) const
     {
         if (sz != v.sz)
             throw std::invalid_argument("Vectors must have the same size");
+        TMATRIX_METRIC_SCOPE(vector_sub, sz, sz, 3 * sz * sizeof(T));
         TDynamicVector res(sz);
-        for (size_t i = 0; i < sz; i++)
-            res[i] = pMem[i] - v.pMem[i];
+        T* r = res.pMem;
+        const T* pv = v.pMem;
+        for_chunks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                r[i] = pMem[i] - pv[i];
+        });
         return res;
     }
-    T operator*(const TDynamicVector& v) noexcept(noexcept(T()))
+    // скалярное произведение с политикой суммирования по умолчанию
+    T operator*(const TDynamicVector& v) const
+    {
+        return dot(v, TSumConfig<T>::policy());
+    }
+    // Скалярное произведение с заданной политикой суммирования.
+    // Большие векторы суммируются блоками по DOT_BLOCK элементов,
+    // суммы блоков складываются попарным деревом в фиксированном порядке -
+    // результат не зависит от числа потоков
+    T dot(const TDynamicVector& v, TSumPolicy policy) const
     {
         if (sz != v.sz)
-            throw "Vectors must have the same size for multiplication";
-        T res = T();
-        for (size_t i = 0; i < sz; i++)
-            res += pMem[i] * v.pMem[i];
-        return res;
+            throw std::invalid_argument("Vectors must have the same size for multiplication");
+        TMATRIX_PERF_SCOPE("dot");
+        TMATRIX_TRACE_SCOPE("dot");
+        TMATRIX_METRIC_SCOPE(dot, 1, 2 * sz, 2 * sz * sizeof(T));
+        if (sz < TParallelConfig::threshold())
+            return TAccumulate<T>::dot(pMem, v.pMem, sz, policy);
+        size_t blocks = (sz + DOT_BLOCK - 1) / DOT_BLOCK;
+        std::vector<T> partial(blocks);
+        const T* pv = v.pMem;
+        auto kernel = [&](size_t b0, size_t b1) {
+            for (size_t b = b0; b < b1; b++) {
+                size_t e = std::min(sz, (b + 1) * DOT_BLOCK);
+                partial[b] = TAccumulate<T>::dot(pMem + b * DOT_BLOCK, pv + b * DOT_BLOCK, e - b * DOT_BLOCK, policy);
+            }
+        };
+        if (TParallelConfig::use_parallel(sz))
+            parallel_for_aligned(blocks, 1, kernel);
+        else
+            kernel(0, blocks);
+        for (size_t step = 1; step < blocks; step *= 2)
+            for (size_t i = 0; i + step < blocks; i += 2 * step)
+                partial[i] += partial[i + step];
+        return partial[0];
     }
 
     friend void swap(TDynamicVector& lhs, TDynamicVector& rhs) noexcept
     {
-        std::swap(lhs.sz, rhs.sz);
-        std::swap(lhs.pMem, rhs.pMem);
+        if (!lhs.is_inline() && !rhs.is_inline()) {
+            std::swap(lhs.sz, rhs.sz);
+            std::swap(lhs.pMem, rhs.pMem);
+            std::swap(lhs.mapped, rhs.mapped);
+            return;
+        }
+        TDynamicVector tmp(std::move(lhs));
+        lhs = std::move(rhs);
+        rhs = std::move(tmp);
     }
 
     // ввод/вывод
@@ -214,14 +446,38 @@ class TDynamicMatrix : public TDynamicVector<TDynamicVector<T>>
 {
     using TDynamicVector<TDynamicVector<T>>::pMem;
     using TDynamicVector<TDynamicVector<T>>::sz;
+
+    // Строки блоками: при политике first_touch строки выделяют и заполняют
+    // потоки пула, и поэлементные ядра (сложение, вычитание, умножение на
+    // скаляр, умножение на вектор) обходят строки этим же разбиением, поэтому
+    // каждый блок обрабатывает поток, коснувшийся его страниц первым.
+    // GEMM делит строки по-своему и этой привязки не имеет
+    template<typename F>
+    void for_row_blocks(F&& f) const
+    {
+        if (TNumaConfig::policy() == TNumaPolicy::first_touch && TParallelConfig::use_parallel(sz * sz))
+            parallel_for(0, sz, 1, f);
+        else
+            f(size_t(0), sz);
+    }
 public:
     TDynamicMatrix(size_t s = 1) : TDynamicVector<TDynamicVector<T>>(s)
     {
         if (s >= MAX_MATRIX_SIZE)
             throw std::invalid_argument("Too large size of matrix");
-        for (size_t i = 0; i < sz; i++)
-            pMem[i] = TDynamicVector<T>(sz);
+        for_row_blocks([this](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                pMem[i] = TDynamicVector<T>(sz);
+        });
+    }
+    TDynamicMatrix(const TDynamicMatrix& m) : TDynamicVector<TDynamicVector<T>>(m.sz)
+    {
+        for_row_blocks([this, &m](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                pMem[i] = m.pMem[i];
+        });
     }
+    TDynamicMatrix(TDynamicMatrix&& m) noexcept = default;
 
     using TDynamicVector<TDynamicVector<T>>::operator[];
     using TDynamicVector<TDynamicVector<T>>::operator=;
@@ -248,91 +504,133 @@ public:
     {
         if (sz != m.sz)
             return false; // Сравниваем размеры
-        for (size_t i = 0; i < sz; i++)
-            if (pMem[i] != m.pMem[i])
-                return false; // Сравниваем строки
-        return true;
+        if (!TParallelConfig::use_parallel(sz * sz)) {
+            for (size_t i = 0; i < sz; i++)
+                if (pMem[i] != m.pMem[i])
+                    return false; // Сравниваем строки
+            return true;
+        }
+        // строки делятся между потоками, различие останавливает всех
+        std::atomic<bool> equal(true);
+        try {
+            parallel_for(0, sz, 1, [&](size_t r0, size_t r1) {
+                for (size_t i = r0; i < r1 && equal.load(std::memory_order_relaxed); i++)
+                    if (pMem[i] != m.pMem[i])
+                        equal.store(false, std::memory_order_relaxed);
+            });
+        }
+        catch (...) {
+            // задачи не удалось запустить (нехватка памяти) - сравнение здесь
+            for (size_t i = 0; i < sz; i++)
+                if (pMem[i] != m.pMem[i])
+                    return false;
+            return true;
+        }
+        return equal.load();
     }
 
     // матрично-скалярные операции
-    TDynamicMatrix operator*(const T& val)
+    TDynamicMatrix operator*(const T& val) const
     {
+        TMATRIX_METRIC_SCOPE(matrix_scalar, sz * sz, sz * sz, 2 * sz * sz * sizeof(T));
         TDynamicMatrix res(sz); // Создаем новый матричный объект
-        for (size_t i = 0; i < sz; i++)
-            for (size_t j = 0; j < sz; j++)
-                res[i][j] = pMem[i][j] * val; // Умножаем элемент матрицы на скаляр
+        for_row_blocks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                for (size_t j = 0; j < sz; j++)
+                    res[i][j] = pMem[i][j] * val; // Умножаем элемент матрицы на скаляр
+        });
         return res;
     }
 
     // матрично-векторные операции
-    TDynamicVector<T> operator*(const TDynamicVector<T>& v)
-    {
-        TDynamicMatrix res(sz);
-        for (size_t i = 0; i < sz; i++)
-            for (size_t j = 0; j < sz; j++)
-                res[i][j] = pMem[i][j] * val; // Умножаем элемент матрицы на скаляр
+    TDynamicVector<T> operator*(const TDynamicVector<T>& v) const
+    {
+        return multiply(v, TSumConfig<T>::policy());
+    }
+    TDynamicVector<T> multiply(const TDynamicVector<T>& v, TSumPolicy policy) const
+    {
+        if (sz != v.size())
+            throw std::invalid_argument("Matrix and vector sizes are incompatible for multiplication");
+        TMATRIX_PERF_SCOPE("gemv");
+        TMATRIX_TRACE_SCOPE("gemv");
+        TMATRIX_METRIC_SCOPE(gemv, sz, 2 * sz * sz, (sz * sz + 2 * sz) * sizeof(T));
+        TDynamicVector<T> res(sz);
+        for_row_blocks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                res[i] = pMem[i].dot(v, policy); // Скалярное произведение строки на вектор
+        });
         return res;
     }
 
     // матрично-матричные операции
-    TDynamicMatrix operator+(const TDynamicMatrix& m)
+    TDynamicMatrix operator+(const TDynamicMatrix& m) const
     {
         if (sz != m.sz)
             throw std::invalid_argument("Matrices must have the same size");
+        TMATRIX_PERF_SCOPE("matrix_add");
+        TMATRIX_TRACE_SCOPE("matrix_add");
+        TMATRIX_METRIC_SCOPE(matrix_add, sz * sz, sz * sz, 3 * sz * sz * sizeof(T));
         TDynamicMatrix res(sz);
-        for (size_t i = 0; i < sz; i++)
-            for (int j = 0;j < sz;j++)
-                res[i][j] = pMem[i][j] + m.pMem[i][j]; // Сложение матриц
+        for_row_blocks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                for (int j = 0;j < sz;j++)
+                    res[i][j] = pMem[i][j] + m.pMem[i][j]; // Сложение матриц
+        });
         return res;
     }
-    TDynamicMatrix operator-(const TDynamicMatrix& m)
+    TDynamicMatrix operator-(const TDynamicMatrix& m) const
     {
         if (sz != m.sz)
             throw std::invalid_argument("Matrices must have the same size");
+        TMATRIX_PERF_SCOPE("matrix_sub");
+        TMATRIX_TRACE_SCOPE("matrix_sub");
+        TMATRIX_METRIC_SCOPE(matrix_sub, sz * sz, sz * sz, 3 * sz * sz * sizeof(T));
         TDynamicMatrix<T> res(sz);
-        for (size_t i = 0; i < sz; i++)
-            for (int j = 0; j < pMem[i].size(); j++)
-                res[i][j] = pMem[i][j] - m.pMem[i][j];
+        for_row_blocks([&](size_t b, size_t e) {
+            for (size_t i = b; i < e; i++)
+                for (int j = 0; j < pMem[i].size(); j++)
+                    res[i][j] = pMem[i][j] - m.pMem[i][j];
+        });
         return res;
     }
-    TDynamicMatrix operator*(const TDynamicMatrix& m)
+    TDynamicMatrix operator*(const TDynamicMatrix& m) const
+    {
+        return multiply(m, TSumConfig<T>::policy());
+    }
+    TDynamicMatrix multiply(const TDynamicMatrix& m, TSumPolicy policy) const
     {
         if (sz != m.sz)
             throw std::invalid_argument("Matrix sizes are incompatible for multiplication");
+        TMATRIX_METRIC_SCOPE(gemm, sz * sz, 2 * sz * sz * sz, 3 * sz * sz * sizeof(T));
         TDynamicMatrix res(sz);
-        for (size_t i = 0; i < sz; i++)
-            for (size_t j = 0; j < sz; j++) {
-                res[i][j] = 0;
-                for (size_t k = 0; k < sz; k++)
-                    res[i][j] += pMem[i][k] * m.pMem[k][j];
-            }
+        std::vector<const T*> a(sz), b(sz);
+        std::vector<T*> c(sz);
+        for (size_t i = 0; i < sz; i++) {
+            a[i] = pMem[i].data();
+            b[i] = m.pMem[i].data();
+            c[i] = res.pMem[i].data();
+        }
+        TGemm<T>::multiply({ a.data(), 0 }, { b.data(), 0 }, { c.data(), 0 }, sz, policy);
         return res;
     }
 
     TDynamicMatrix& operator=(const TDynamicMatrix& m) {
-        if (this != &m) {
-            if (sz != m.sz)
-            {
-                delete[] pMem;
-                sz = m.sz;
-                pMem = new TDynamicVector<T>[m.sz];
-            }
-            for (int i = 0; i < sz; i++) {
-                pMem[i] = m.pMem[i];
-            }
-        }
+        TDynamicVector<TDynamicVector<T>>::operator=(m);
         return *this;
     }
+    TDynamicMatrix& operator=(TDynamicMatrix&& m) noexcept = default;
 
     // ввод/вывод
     friend istream& operator>>(istream& istr, TDynamicMatrix& v)
     {
+        TMATRIX_TRACE_SCOPE("matrix_read");
         for (size_t i = 0; i < v.sz; i++)
             istr >> v.pMem[i];
         return istr;
     }
     friend ostream& operator<<(ostream& ostr, const TDynamicMatrix& v)
     {
+        TMATRIX_TRACE_SCOPE("matrix_write");
         for (size_t i = 0; i < v.sz; i++) {
             for (size_t j = 0; j < v.sz; j++)
                 ostr << v.pMem[i][j] << " ";
@@ -0,0 +1,202 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Кэш результатов матричных операций по хешам содержимого операндов
+
+#ifndef __TMemo_H__
+#define __TMemo_H__
+
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "tcowmatrix.h"
+#include "thash.h"
+
+// Операции, результаты которых кэшируются
+enum class TMemoOp : uint32_t
+{
+    multiply,
+    add,
+    sub
+};
+
+struct TMemoStats
+{
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    size_t entries;
+    size_t bytes;       // занято результатами
+};
+
+// LRU-кэш результатов для матриц с элементами T. Ключ - операция, размер,
+// хеши XXH64 обоих операндов, а для умножения еще политика суммирования и
+// параметры TGemmConfig<T> - от них зависит результат, и после их смены
+// старые произведения не возвращаются. Операнды при попадании не сравниваются:
+// при совпадении хешей разных матриц (вероятность порядка 2^-64 на пару)
+// вернется чужой результат.
+// Результаты хранятся как TCowMatrix: попадание возвращает общий буфер
+// без копирования, запись в полученную матрицу отделяет её от кэша.
+// По умолчанию кэш выключен (емкость 0)
+template<typename T>
+class TMemoCache
+{
+    struct TKey
+    {
+        TMemoOp op;
+        TSumPolicy policy;
+        size_t n;
+        uint64_t ha, hb;
+        uint64_t settings;  // свертка параметров умножения
+
+        bool operator==(const TKey& k) const noexcept
+        {
+            return op == k.op && policy == k.policy && n == k.n && ha == k.ha && hb == k.hb
+                && settings == k.settings;
+        }
+    };
+    struct TKeyHash
+    {
+        size_t operator()(const TKey& k) const noexcept
+        {
+            return (size_t)(k.ha ^ (k.hb * 0x9E3779B185EBCA87ull) ^ ((uint64_t)k.op << 56)
+                ^ ((uint64_t)k.policy << 48) ^ k.n ^ (k.settings * 0xC2B2AE3D27D4EB4Full));
+        }
+    };
+    typedef std::list<std::pair<TKey, TCowMatrix<T>>> TList;
+
+    TList lru;  // в начале - недавно использованные
+    std::unordered_map<TKey, typename TList::iterator, TKeyHash> index;
+    mutable std::mutex mtx;
+    size_t cap = 0, used = 0;
+    size_t hits = 0, misses = 0, evictions = 0;
+
+    static size_t bytes_of(size_t n) noexcept { return n * n * sizeof(T); }
+
+    // параметры TGemmConfig<T>, от которых зависит произведение, одним числом
+    static uint64_t gemm_settings()
+    {
+        const TGemmParams p = TGemmConfig<T>::snapshot();
+        uint64_t tol;
+        std::memcpy(&tol, &p.tolerance, sizeof(tol));
+        uint64_t f[] = { p.block_size, p.parallel_threshold, p.strassen_threshold, p.strassen_cutoff,
+            p.precision_check ? 1u : 0u, tol };
+        uint64_t h = 0;
+        for (uint64_t x : f)
+            h = (h ^ x) * 0x9E3779B185EBCA87ull + 0x165667B19E3779F9ull;
+        return h;
+    }
+
+    // вытеснение старых записей, пока занято больше limit
+    void shrink(size_t limit)
+    {
+        while (used > limit && !lru.empty()) {
+            used -= bytes_of(lru.back().first.n);
+            index.erase(lru.back().first);
+            lru.pop_back();
+            evictions++;
+        }
+    }
+    bool find(const TKey& k, TCowMatrix<T>& res)
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto it = index.find(k);
+        if (it == index.end()) {
+            misses++;
+            return false;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        res = it->second->second;
+        hits++;
+        return true;
+    }
+    void insert(const TKey& k, const TCowMatrix<T>& res)
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        size_t b = bytes_of(k.n);
+        if (b > cap || index.count(k))
+            return;
+        shrink(cap - b);
+        lru.emplace_front(k, res);
+        index.emplace(k, lru.begin());
+        used += b;
+    }
+public:
+    static TMemoCache& instance()
+    {
+        static TMemoCache c;
+        return c;
+    }
+
+    // емкость в байтах данных результатов, 0 - кэш выключен
+    void set_capacity(size_t bytes)
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        cap = bytes;
+        shrink(cap);
+    }
+    size_t capacity() const
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        return cap;
+    }
+    bool enabled() const { return capacity() != 0; }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        lru.clear();
+        index.clear();
+        used = 0;
+    }
+    TMemoStats stats() const
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        return { hits, misses, evictions, index.size(), used };
+    }
+    void reset_stats()
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        hits = misses = evictions = 0;
+    }
+
+    // результат op(a, b) из кэша или вычисленный f(); вычисление идет без блокировки,
+    // одновременные промахи по одному ключу считают результат независимо
+    template<typename F>
+    TCowMatrix<T> get_or_compute(TMemoOp op, const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, F f)
+    {
+        if (!enabled())
+            return TCowMatrix<T>(f());
+        // сложение и вычитание от настроек умножения не зависят
+        bool mul = op == TMemoOp::multiply;
+        TKey k = { op, mul ? TSumConfig<T>::policy() : TSumPolicy::naive, a.size(), content_hash(a), content_hash(b),
+            mul ? gemm_settings() : 0 };
+        TCowMatrix<T> res;
+        if (find(k, res))
+            return res;
+        res = TCowMatrix<T>(f());
+        insert(k, res);
+        return res;
+    }
+};
+
+// Произведение с кэшированием: повторное умножение тех же матриц - поиск по хешам
+template<typename T>
+TCowMatrix<T> memo_multiply(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+    return TMemoCache<T>::instance().get_or_compute(TMemoOp::multiply, a, b, [&]() { return a * b; });
+}
+template<typename T>
+TCowMatrix<T> memo_add(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+    return TMemoCache<T>::instance().get_or_compute(TMemoOp::add, a, b, [&]() { return a + b; });
+}
+template<typename T>
+TCowMatrix<T> memo_sub(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+    return TMemoCache<T>::instance().get_or_compute(TMemoOp::sub, a, b, [&]() { return a - b; });
+}
+
+#endif
@@ -0,0 +1,253 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Счетчики операций: вызовы, элементы, FLOP, байты, выделения памяти и время
+
+#ifndef __TMetrics_H__
+#define __TMetrics_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Учитываемые операции
+struct TMetricOp
+{
+    enum
+    {
+        none,           // вне операторов: конструкторы, копирование
+        vector_scalar,
+        vector_add,
+        vector_sub,
+        dot,
+        matrix_scalar,
+        matrix_add,
+        matrix_sub,
+        gemv,
+        gemm,
+        COUNT
+    };
+    static const char* name(size_t op) noexcept
+    {
+        static const char* names[COUNT] = { "none", "vector_scalar", "vector_add", "vector_sub", "dot",
+            "matrix_scalar", "matrix_add", "matrix_sub", "gemv", "gemm" };
+        return names[op];
+    }
+};
+
+// Значения по одной операции. FLOP и байты - оценки по размерам операндов
+// (обязательный трафик: чтение аргументов и запись результата)
+struct TOpMetrics
+{
+    uint64_t calls = 0;
+    uint64_t elements = 0;      // элементов результата
+    uint64_t flops = 0;
+    uint64_t bytes = 0;
+    uint64_t allocations = 0;   // выделения памяти под векторы внутри операции
+    uint64_t alloc_bytes = 0;
+    uint64_t nanoseconds = 0;
+};
+
+struct TMetricsSnapshot
+{
+    TOpMetrics ops[TMetricOp::COUNT];
+
+    const TOpMetrics& operator[](size_t op) const noexcept { return ops[op]; }
+};
+
+// Счетчики хранятся в каждом потоке отдельно: поток пишет только свои,
+// без блокировок и атомарных read-modify-write. snapshot() суммирует все
+// живые потоки и итоги завершившихся
+class TMetrics
+{
+    static constexpr size_t FIELDS = 7;
+
+    struct TRegistry;
+    struct TLocal
+    {
+        std::atomic<uint64_t> v[TMetricOp::COUNT][FIELDS];
+        size_t current;         // операция, которой приписываются выделения памяти
+
+        TLocal();
+        ~TLocal();
+    };
+    struct TRegistry
+    {
+        std::mutex mtx;
+        std::vector<TLocal*> live;
+        uint64_t retired[TMetricOp::COUNT][FIELDS] = {};
+    };
+
+    // не разрушается: потоки пула завершаются при выходе из программы и обращаются к нему
+    static TRegistry& registry()
+    {
+        static TRegistry* r = new TRegistry;
+        return *r;
+    }
+    static TLocal& local()
+    {
+        thread_local TLocal l;
+        return l;
+    }
+    // пишет только поток-владелец, поэтому хватает отдельных load и store
+    static void bump(std::atomic<uint64_t>& c, uint64_t x) noexcept
+    {
+        c.store(c.load(std::memory_order_relaxed) + x, std::memory_order_relaxed);
+    }
+    static void to_metrics(const uint64_t* f, TOpMetrics& m) noexcept
+    {
+        m.calls += f[0];
+        m.elements += f[1];
+        m.flops += f[2];
+        m.bytes += f[3];
+        m.allocations += f[4];
+        m.alloc_bytes += f[5];
+        m.nanoseconds += f[6];
+    }
+public:
+    static void record(size_t op, uint64_t elements, uint64_t flops, uint64_t bytes, uint64_t ns) noexcept
+    {
+        TLocal& l = local();
+        bump(l.v[op][0], 1);
+        bump(l.v[op][1], elements);
+        bump(l.v[op][2], flops);
+        bump(l.v[op][3], bytes);
+        bump(l.v[op][6], ns);
+    }
+    static void allocation(uint64_t bytes) noexcept
+    {
+        TLocal& l = local();
+        bump(l.v[l.current][4], 1);
+        bump(l.v[l.current][5], bytes);
+    }
+    // операция, которую выполняет поток, или none
+    static size_t current() noexcept { return local().current; }
+    // операция, к которой относятся следующие выделения; возвращает предыдущую
+    static size_t enter(size_t op) noexcept
+    {
+        TLocal& l = local();
+        size_t prev = l.current;
+        l.current = op;
+        return prev;
+    }
+
+    static TMetricsSnapshot snapshot()
+    {
+        TMetricsSnapshot s;
+        TRegistry& r = registry();
+        std::lock_guard<std::mutex> lk(r.mtx);
+        for (size_t op = 0; op < TMetricOp::COUNT; op++) {
+            to_metrics(r.retired[op], s.ops[op]);
+            for (TLocal* l : r.live) {
+                uint64_t f[FIELDS];
+                for (size_t k = 0; k < FIELDS; k++)
+                    f[k] = l->v[op][k].load(std::memory_order_relaxed);
+                to_metrics(f, s.ops[op]);
+            }
+        }
+        return s;
+    }
+    // обнуление во время работы других потоков может потерять их одновременные приращения
+    static void reset()
+    {
+        TRegistry& r = registry();
+        std::lock_guard<std::mutex> lk(r.mtx);
+        for (size_t op = 0; op < TMetricOp::COUNT; op++)
+            for (size_t k = 0; k < FIELDS; k++) {
+                r.retired[op][k] = 0;
+                for (TLocal* l : r.live)
+                    l->v[op][k].store(0, std::memory_order_relaxed);
+            }
+    }
+};
+
+inline TMetrics::TLocal::TLocal() : current(TMetricOp::none)
+{
+    for (size_t op = 0; op < TMetricOp::COUNT; op++)
+        for (size_t k = 0; k < FIELDS; k++)
+            v[op][k].store(0, std::memory_order_relaxed);
+    TRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mtx);
+    r.live.push_back(this);
+}
+inline TMetrics::TLocal::~TLocal()
+{
+    TRegistry& r = registry();
+    std::lock_guard<std::mutex> lk(r.mtx);
+    for (size_t op = 0; op < TMetricOp::COUNT; op++)
+        for (size_t k = 0; k < FIELDS; k++)
+            r.retired[op][k] += v[op][k].load(std::memory_order_relaxed);
+    for (size_t i = 0; i < r.live.size(); i++)
+        if (r.live[i] == this) {
+            r.live[i] = r.live.back();
+            r.live.pop_back();
+            break;
+        }
+}
+
+// Область операции: вызов с объемами работы и время до выхода из области;
+// выделения памяти внутри приписываются этой операции. Записывается только
+// внешняя область потока: dot внутри gemv не добавляет вызовов и второй раз
+// не считает то же время, его выделения относятся к gemv
+class TMetricScope
+{
+    size_t op;
+    bool outer;
+    uint64_t elements, flops, bytes;
+    std::chrono::steady_clock::time_point t0;
+public:
+    TMetricScope(size_t o, uint64_t e, uint64_t f, uint64_t b) noexcept
+        : op(o), outer(TMetrics::current() == TMetricOp::none), elements(e), flops(f), bytes(b)
+    {
+        if (!outer)
+            return;
+        TMetrics::enter(o);
+        t0 = std::chrono::steady_clock::now();
+    }
+    TMetricScope(const TMetricScope&) = delete;
+    TMetricScope& operator=(const TMetricScope&) = delete;
+    ~TMetricScope()
+    {
+        if (!outer)
+            return;
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - t0).count();
+        TMetrics::record(op, elements, flops, bytes, ns);
+        TMetrics::enter(TMetricOp::none);
+    }
+};
+
+// Задача пула, запущенная внутри операции op: поток пула на время задачи
+// работает в счет op - его выделения приписываются ей, а области внутри
+// задачи (dot в куске строк gemv) не записываются
+class TMetricTask
+{
+    size_t prev;
+public:
+    explicit TMetricTask(size_t op) noexcept : prev(TMetrics::current())
+    {
+        if (prev == TMetricOp::none)
+            TMetrics::enter(op);
+    }
+    TMetricTask(const TMetricTask&) = delete;
+    TMetricTask& operator=(const TMetricTask&) = delete;
+    ~TMetricTask() { TMetrics::enter(prev); }
+};
+
+// Без TMATRIX_ENABLE_METRICS макросы пусты и счетчики не собираются.
+// TMATRIX_METRIC_CAPTURE и TMATRIX_METRIC_TASK() - для задач пула, как у счетчиков perf
+#if defined(TMATRIX_ENABLE_METRICS)
+#define TMATRIX_METRIC_SCOPE(op, elements, flops, bytes) \
+    TMetricScope tmatrix_metric_scope_(TMetricOp::op, elements, flops, bytes)
+#define TMATRIX_METRIC_ALLOC(bytes) TMetrics::allocation(bytes)
+#define TMATRIX_METRIC_CAPTURE , tmatrix_metric_ = TMetrics::current()
+#define TMATRIX_METRIC_TASK() TMetricTask tmatrix_metric_task_(tmatrix_metric_)
+#else
+#define TMATRIX_METRIC_SCOPE(op, elements, flops, bytes)
+#define TMATRIX_METRIC_ALLOC(bytes) ((void)0)
+#define TMATRIX_METRIC_CAPTURE
+#define TMATRIX_METRIC_TASK()
+#endif
+
+#endif
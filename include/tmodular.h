@@ -0,0 +1,280 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Вычеты по простому модулю: умножение Монтгомери, умножение матриц
+// с отложенным приведением, определитель и обратная матрица
+
+#ifndef __TModular_H__
+#define __TModular_H__
+
+#include <cstdint>
+#include <vector>
+#include "tmatrix.h"
+
+// Вычет по нечетному модулю P < 2^31 в представлении Монтгомери: хранится x * 2^32 mod P.
+// Сложение и вычитание - как обычно, умножение - без деления
+template<uint32_t P>
+struct TModular
+{
+    static_assert(P % 2 == 1 && P > 2, "Modulus should be an odd prime");
+    static_assert(P < (uint32_t(1) << 31), "Modulus should be less than 2^31");
+
+    uint32_t v;
+
+    // -P^-1 mod 2^32 итерациями Ньютона: каждая удваивает число верных бит
+    static constexpr uint32_t neg_inv()
+    {
+        uint32_t inv = P;
+        for (int i = 0; i < 5; i++)
+            inv *= 2 - P * inv;
+        return 0u - inv;
+    }
+    static constexpr uint32_t NINV = neg_inv();
+    static constexpr uint32_t R1 = (uint32_t)((uint64_t(1) << 32) % P);
+    static constexpr uint32_t R2 = (uint32_t)((uint64_t)R1 * R1 % P);
+
+    // t * 2^-32 mod P для t < P * 2^32
+    static uint32_t reduce(uint64_t t) noexcept
+    {
+        uint32_t m = (uint32_t)t * NINV;
+        uint32_t u = (uint32_t)((t + (uint64_t)m * P) >> 32);
+        return u >= P ? u - P : u;
+    }
+    static uint32_t mul(uint32_t a, uint32_t b) noexcept { return reduce((uint64_t)a * b); }
+    static uint32_t add(uint32_t a, uint32_t b) noexcept
+    {
+        uint32_t s = a + b;
+        return s >= P ? s - P : s;
+    }
+    static uint32_t sub(uint32_t a, uint32_t b) noexcept
+    {
+        return a >= b ? a - b : a + P - b;
+    }
+
+    static TModular from_raw(uint32_t r) noexcept
+    {
+        TModular x;
+        x.v = r;
+        return x;
+    }
+
+    TModular() noexcept : v(0) {}
+    TModular(long long x) noexcept
+    {
+        long long r = x % (long long)P;
+        v = mul((uint32_t)(r < 0 ? r + P : r), R2);
+    }
+
+    static constexpr uint32_t modulus() noexcept { return P; }
+    // обычное представление в [0, P)
+    uint32_t value() const noexcept { return reduce(v); }
+
+    TModular pow(uint64_t e) const noexcept
+    {
+        uint32_t r = R1, b = v;
+        for (; e; e >>= 1) {
+            if (e & 1)
+                r = mul(r, b);
+            b = mul(b, b);
+        }
+        return from_raw(r);
+    }
+    // обратный по малой теореме Ферма
+    TModular inv() const
+    {
+        if (v == 0)
+            throw std::invalid_argument("Zero has no inverse");
+        return pow(P - 2);
+    }
+
+    friend TModular operator+(TModular a, TModular b) noexcept { return from_raw(add(a.v, b.v)); }
+    friend TModular operator-(TModular a, TModular b) noexcept { return from_raw(sub(a.v, b.v)); }
+    friend TModular operator*(TModular a, TModular b) noexcept { return from_raw(mul(a.v, b.v)); }
+    friend TModular operator/(TModular a, TModular b) { return a * b.inv(); }
+    friend TModular operator-(TModular a) noexcept { return from_raw(sub(0, a.v)); }
+    friend TModular& operator+=(TModular& a, TModular b) noexcept { return a = a + b; }
+    friend TModular& operator-=(TModular& a, TModular b) noexcept { return a = a - b; }
+    friend TModular& operator*=(TModular& a, TModular b) noexcept { return a = a * b; }
+    friend TModular& operator/=(TModular& a, TModular b) { return a = a / b; }
+
+    // представление однозначно, так как v < P
+    friend bool operator==(TModular a, TModular b) noexcept { return a.v == b.v; }
+    friend bool operator!=(TModular a, TModular b) noexcept { return a.v != b.v; }
+
+    friend istream& operator>>(istream& istr, TModular& x)
+    {
+        long long r;
+        if (istr >> r)
+            x = TModular(r);
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, TModular x)
+    {
+        return ostr << x.value();
+    }
+};
+
+// v < P, поэтому равные вычеты совпадают побитово
+template<uint32_t P>
+struct TBitwiseEqual<TModular<P>>
+{
+    static constexpr bool value = true;
+};
+
+template<uint32_t P>
+struct TTuningTag<TModular<P>>
+{
+    static std::string name() { return "mod" + std::to_string(P); }
+};
+
+// Умножение матриц вычетов. Произведения a * b < P^2 копятся в uint64 без приведения;
+// раз в STEPS слагаемых из суммы вычитается LIMIT (кратное P^2, около 2^63),
+// и только в конце сумма приводится по модулю один раз на элемент.
+// Внутренний цикл - умножение 32 x 32 -> 64 и сложение, векторизуется (vpmuludq)
+template<uint32_t P>
+struct TGemmKernel<TModular<P>>
+{
+    typedef TModular<P> T;
+    typedef TMatrixView<const T> CView;
+    typedef TMatrixView<T> View;
+
+    static constexpr bool custom = true;
+    static constexpr uint64_t SQUARE = (uint64_t)P * P;
+    static constexpr uint64_t LIMIT = ((uint64_t(1) << 63) / SQUARE) * SQUARE;
+    static constexpr size_t STEPS = (size_t)(LIMIT / SQUARE);
+    static constexpr size_t RB = 16, JB = 256, KB = 128;  // блоки строк, столбцов и k
+
+    static void rows(CView a, CView b, View c, size_t n, size_t r0, size_t r1)
+    {
+        std::vector<uint64_t> acc(RB * JB);
+        for (size_t ii = r0; ii < r1; ii += RB) {
+            size_t ie = std::min(ii + RB, r1);
+            for (size_t jj = 0; jj < n; jj += JB) {
+                size_t je = std::min(jj + JB, n), jn = je - jj;
+                std::fill(acc.begin(), acc.end(), 0);
+                for (size_t kk = 0; kk < n; kk += KB) {
+                    size_t ke = std::min(kk + KB, n);
+                    for (size_t i = ii; i < ie; i++) {
+                        const T* pa = a.row(i);
+                        uint64_t* pc = acc.data() + (i - ii) * JB;
+                        for (size_t k = kk; k < ke; k++) {
+                            const uint64_t aik = pa[k].v;
+                            const T* pb = b.row(k) + jj;
+                            for (size_t j = 0; j < jn; j++)
+                                pc[j] += aik * pb[j].v;
+                            if ((k + 1) % STEPS == 0)
+                                for (size_t j = 0; j < jn; j++)
+                                    pc[j] = pc[j] >= LIMIT ? pc[j] - LIMIT : pc[j];
+                        }
+                    }
+                }
+                // сумма a * R * b * R: одно приведение дает (a * b) * R
+                for (size_t i = ii; i < ie; i++) {
+                    const uint64_t* pc = acc.data() + (i - ii) * JB;
+                    T* pr = c.row(i) + jj;
+                    for (size_t j = 0; j < jn; j++)
+                        pr[j] = T::from_raw(T::reduce(pc[j] % P));
+                }
+            }
+        }
+    }
+
+    static void multiply(CView a, CView b, View c, size_t n)
+    {
+        if (n < TGemmConfig<T>::snapshot().parallel_threshold) {
+            rows(a, b, c, n, 0, n);
+            return;
+        }
+        parallel_for(0, n, RB, [&](size_t r0, size_t r1) { rows(a, b, c, n, r0, r1); });
+    }
+};
+
+// Определитель и обратная матрица методом Гаусса над полем вычетов
+template<uint32_t P>
+class TModularAlgebra
+{
+    typedef TModular<P> T;
+    static constexpr size_t PARALLEL_SIZE = 128;
+
+    // row[q] -= f * piv[q] для q в [from, len)
+    static void eliminate(uint32_t* row, const uint32_t* piv, uint32_t f, size_t from, size_t len) noexcept
+    {
+        for (size_t q = from; q < len; q++)
+            row[q] = T::sub(row[q], T::mul(f, piv[q]));
+    }
+
+    // приведение n x w таблицы к ступенчатому виду по первым n столбцам;
+    // jordan - исключение и выше ведущих элементов, с нормировкой строк.
+    // Возвращает произведение ведущих элементов со знаком перестановки или 0
+    static uint32_t gauss(std::vector<uint32_t>& t, size_t n, size_t w, bool jordan)
+    {
+        uint32_t det = T::R1;
+        for (size_t col = 0; col < n; col++) {
+            size_t piv = col;
+            while (piv < n && t[piv * w + col] == 0)
+                piv++;
+            if (piv == n)
+                return 0;
+            if (piv != col) {
+                std::swap_ranges(t.begin() + piv * w, t.begin() + (piv + 1) * w, t.begin() + col * w);
+                det = T::sub(0, det);
+            }
+            uint32_t* prow = t.data() + col * w;
+            det = T::mul(det, prow[col]);
+            if (jordan) {
+                uint32_t inv = T::from_raw(prow[col]).inv().v;
+                for (size_t q = col; q < w; q++)
+                    prow[q] = T::mul(prow[q], inv);
+            }
+            const uint32_t pinv = jordan ? T::R1 : T::from_raw(prow[col]).inv().v;
+            auto body = [&](size_t r0, size_t r1) {
+                for (size_t r = r0; r < r1; r++) {
+                    uint32_t* row = t.data() + r * w;
+                    if (r == col || row[col] == 0)
+                        continue;
+                    eliminate(row, prow, T::mul(row[col], pinv), col, w);
+                }
+            };
+            size_t first = jordan ? 0 : col + 1;
+            if (n < PARALLEL_SIZE)
+                body(first, n);
+            else
+                parallel_for(first, n, 16, body);
+        }
+        return det;
+    }
+public:
+    static T det(const TDynamicMatrix<T>& m)
+    {
+        TMATRIX_TRACE_SCOPE("modular_det");
+        size_t n = m.size();
+        std::vector<uint32_t> t(n * n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                t[i * n + j] = m[i].data()[j].v;
+        return T::from_raw(gauss(t, n, n, false));
+    }
+
+    // Гаусс-Жордан над [A | E]
+    static TDynamicMatrix<T> inverse(const TDynamicMatrix<T>& m)
+    {
+        TMATRIX_TRACE_SCOPE("modular_inverse");
+        size_t n = m.size(), w = 2 * n;
+        std::vector<uint32_t> t(n * w, 0);
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++)
+                t[i * w + j] = m[i].data()[j].v;
+            t[i * w + n + i] = T::R1;
+        }
+        if (gauss(t, n, w, true) == 0)
+            throw std::invalid_argument("Matrix is singular");
+        TDynamicMatrix<T> res(n);
+        for (size_t i = 0; i < n; i++) {
+            T* p = res[i].data();
+            for (size_t j = 0; j < n; j++)
+                p[j] = T::from_raw(t[i * w + n + j]);
+        }
+        return res;
+    }
+};
+
+#endif
@@ -0,0 +1,225 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Размещение памяти и потоков по узлам NUMA
+
+#ifndef __TNuma_H__
+#define __TNuma_H__
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Политика размещения больших массивов тривиальных типов
+enum class TNumaPolicy
+{
+    local,          // как решит система: обычно узел потока, выделившего память
+    interleave,     // страницы по очереди на всех узлах (mbind MPOL_INTERLEAVE)
+    first_touch     // страницы заполняют потоки пула, которые потом их обрабатывают
+};
+
+struct TNumaConfig
+{
+    static TNumaPolicy& policy()
+    {
+        static TNumaPolicy p = TNumaPolicy::local;
+        return p;
+    }
+};
+
+// Топология читается из /sys/devices/system/node, системные вызовы делаются
+// напрямую, без libnuma. На других системах и без доступа к sysfs узел один,
+// а привязка и mbind возвращают false
+class TNuma
+{
+    // список вида "0-3,8,10-11"
+    static std::vector<size_t> parse_list(const std::string& s)
+    {
+        std::vector<size_t> res;
+        size_t i = 0;
+        while (i < s.size()) {
+            size_t a = 0, b;
+            bool digits = false;
+            for (; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++, digits = true)
+                a = a * 10 + size_t(s[i] - '0');
+            if (!digits)
+                break;
+            b = a;
+            if (i < s.size() && s[i] == '-') {
+                b = 0;
+                for (i++; i < s.size() && s[i] >= '0' && s[i] <= '9'; i++)
+                    b = b * 10 + size_t(s[i] - '0');
+            }
+            for (size_t k = a; k <= b; k++)
+                res.push_back(k);
+            if (i < s.size() && s[i] == ',')
+                i++;
+            else
+                break;
+        }
+        return res;
+    }
+    static std::vector<size_t> read_list(const std::string& path)
+    {
+        std::string s;
+        if (FILE* f = std::fopen(path.c_str(), "r")) {
+            char buf[4096];
+            size_t n = std::fread(buf, 1, sizeof(buf) - 1, f);
+            std::fclose(f);
+            s.assign(buf, n);
+        }
+        return parse_list(s);
+    }
+    static const std::vector<size_t>& node_ids()
+    {
+        static const std::vector<size_t> ids = []() {
+            std::vector<size_t> r = read_list("/sys/devices/system/node/online");
+            return r.empty() ? std::vector<size_t>{ 0 } : r;
+        }();
+        return ids;
+    }
+#if defined(__linux__)
+    // маска процессоров потока до привязки: привязка ее только сужает,
+    // поэтому ограничения taskset и cgroup сохраняются, а отвязка ее возвращает
+    struct TSavedMask
+    {
+        bool saved = false;
+        cpu_set_t set;
+    };
+    static TSavedMask& saved_mask()
+    {
+        thread_local TSavedMask m;
+        return m;
+    }
+#endif
+public:
+    static constexpr size_t PAGE = 4096;
+
+    static size_t nodes() { return node_ids().size(); }
+
+    // узел потока пула с номером worker из workers: потоки делятся на
+    // непрерывные группы по узлам так же, как parallel_for делит диапазон
+    // на куски (кусок 0 - вызывающий поток, кусок i + 1 - поток i)
+    static size_t node_of_worker(size_t worker, size_t workers)
+    {
+        return (worker + 1) * nodes() / (workers + 1);
+    }
+
+    // номер узла (0 .. nodes() - 1), на котором выполняется поток, или -1
+    static int current_node() noexcept
+    {
+#if defined(__linux__) && defined(SYS_getcpu)
+        unsigned cpu = 0, node = 0;
+        if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+            return -1;
+        const std::vector<size_t>& ids = node_ids();
+        for (size_t i = 0; i < ids.size(); i++)
+            if (ids[i] == node)
+                return (int)i;
+#endif
+        return -1;
+    }
+
+    // Привязка текущего потока к процессорам узла, разрешенным потоку до
+    // первой привязки. false - узла нет или ни один его процессор не разрешен
+    static bool bind_thread(size_t node)
+    {
+#if defined(__linux__)
+        if (node >= nodes())
+            return false;
+        std::vector<size_t> cpus = read_list("/sys/devices/system/node/node" + std::to_string(node_ids()[node]) + "/cpulist");
+        TSavedMask& m = saved_mask();
+        if (!m.saved) {
+            if (sched_getaffinity(0, sizeof(m.set), &m.set) != 0)
+                return false;
+            m.saved = true;
+        }
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (size_t c : cpus)
+            if (c < CPU_SETSIZE && CPU_ISSET(c, &m.set))
+                CPU_SET(c, &set);
+        if (CPU_COUNT(&set) == 0)
+            return false;
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        (void)node;
+        return false;
+#endif
+    }
+    // возврат маски, которая была у потока до bind_thread
+    static void unbind_thread()
+    {
+#if defined(__linux__)
+        TSavedMask& m = saved_mask();
+        if (m.saved) {
+            sched_setaffinity(0, sizeof(m.set), &m.set);
+            m.saved = false;
+        }
+#endif
+    }
+
+    // Чередование страниц [p, p + bytes) по всем узлам. Действует только на
+    // страницы, которых еще не касались: уже размещенные mbind без
+    // MPOL_MF_MOVE не переносит. Границы сужаются до целых страниц
+    static bool interleave(void* p, size_t bytes) noexcept
+    {
+#if defined(__linux__) && defined(SYS_mbind)
+        const int MPOL_INTERLEAVE_MODE = 3;     // MPOL_INTERLEAVE из linux/mempolicy.h
+        uintptr_t b = ((uintptr_t)p + PAGE - 1) & ~(uintptr_t)(PAGE - 1);
+        uintptr_t e = ((uintptr_t)p + bytes) & ~(uintptr_t)(PAGE - 1);
+        if (e <= b)
+            return false;
+        const std::vector<size_t>& ids = node_ids();
+        const size_t BITS = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> mask(ids.back() / BITS + 1, 0);
+        for (size_t id : ids)
+            mask[id / BITS] |= 1ul << (id % BITS);
+        return syscall(SYS_mbind, (void*)b, (unsigned long)(e - b), MPOL_INTERLEAVE_MODE,
+            mask.data(), (unsigned long)(mask.size() * BITS), 0u) == 0;
+#else
+        (void)p;
+        (void)bytes;
+        return false;
+#endif
+    }
+
+    // Новое анонимное отображение под bytes байт с чередованием страниц.
+    // Его страниц еще никто не касался, и политика не достается другим
+    // выделениям. Если mbind недоступен, страницы обычные; nullptr - отображение
+    // не создано. Освобождается unmap с тем же размером
+    static void* map_interleaved(size_t bytes) noexcept
+    {
+#if defined(__linux__)
+        if (bytes == 0)
+            return nullptr;
+        size_t len = (bytes + PAGE - 1) & ~(PAGE - 1);
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED)
+            return nullptr;
+        interleave(p, len);
+        return p;
+#else
+        (void)bytes;
+        return nullptr;
+#endif
+    }
+    static void unmap(void* p, size_t bytes) noexcept
+    {
+#if defined(__linux__)
+        munmap(p, (bytes + PAGE - 1) & ~(PAGE - 1));
+#else
+        (void)p;
+        (void)bytes;
+#endif
+    }
+};
+
+#endif
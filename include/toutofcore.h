@@ -0,0 +1,304 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Матрицы на диске, разбитые на плитки, и умножение вне оперативной памяти
+
+#ifndef __TOutOfCore_H__
+#define __TOutOfCore_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "tasync.h"
+#include "tmatrix.h"
+
+// Файл матрицы n x n из плиток tile x tile.
+// Формат: заголовок (сигнатура "TMTILE01", n, tile, sizeof(T) - по 8 байт),
+// затем плитки по строкам плиток, каждая - tile * tile элементов по строкам.
+// Краевые плитки дополнены нулями до полного размера, поэтому смещение плитки
+// вычисляется без таблицы, а умножение краевых плиток не требует особых случаев.
+// Размер n не ограничен MAX_MATRIX_SIZE - в памяти находятся только плитки.
+// Чтение и запись плиток можно вызывать из разных потоков
+template<typename T>
+class TTiledFile
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Tiles are stored as raw bytes");
+
+    static constexpr char MAGIC[8] = { 'T', 'M', 'T', 'I', 'L', 'E', '0', '1' };
+    static constexpr uint64_t HEADER = 32;
+
+    mutable std::fstream f;
+    mutable std::mutex mtx;
+    uint64_t n, t, cnt;     // размер, сторона плитки, плиток в строке
+
+    uint64_t offset(size_t i, size_t j) const
+    {
+        if (i >= cnt || j >= cnt)
+            throw std::out_of_range("Tile index is out of range");
+        return HEADER + ((uint64_t)i * cnt + j) * t * t * sizeof(T);
+    }
+    void check_tile(const TDynamicMatrix<T>& m) const
+    {
+        if (m.size() != t)
+            throw std::invalid_argument("Tile size should match the file");
+    }
+public:
+    // открытие существующего файла
+    explicit TTiledFile(const std::string& path) : f(path, std::ios::in | std::ios::out | std::ios::binary)
+    {
+        if (!f)
+            throw std::runtime_error("Cannot open tiled matrix file " + path);
+        char magic[8];
+        uint64_t h[3];
+        f.read(magic, sizeof(magic));
+        f.read((char*)h, sizeof(h));
+        if (!f || std::memcmp(magic, MAGIC, sizeof(magic)) != 0)
+            throw std::runtime_error("Not a tiled matrix file " + path);
+        if (h[2] != sizeof(T))
+            throw std::runtime_error("Element size does not match in " + path);
+        if (h[1] == 0 || h[1] >= (uint64_t)MAX_MATRIX_SIZE)
+            throw std::runtime_error("Invalid tile size in " + path);
+        n = h[0];
+        t = h[1];
+        cnt = (n + t - 1) / t;
+    }
+    // создание нулевой матрицы n x n
+    TTiledFile(const std::string& path, size_t size, size_t tile)
+        : f(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc), n(size), t(tile)
+    {
+        if (tile == 0 || tile >= (size_t)MAX_MATRIX_SIZE)
+            throw std::out_of_range("Tile size should be positive and less than MAX_MATRIX_SIZE");
+        if (!f)
+            throw std::runtime_error("Cannot create tiled matrix file " + path);
+        cnt = (n + t - 1) / t;
+        uint64_t h[3] = { n, t, sizeof(T) };
+        f.write(MAGIC, sizeof(MAGIC));
+        f.write((const char*)h, sizeof(h));
+        // пишется только последняя строка последней плитки: промежуток файловая
+        // система заполняет нулями, на большинстве систем - без записи на диск
+        if (cnt != 0) {
+            std::vector<T> zero(t);
+            f.seekp((std::streamoff)(HEADER + (cnt * cnt * t - 1) * t * sizeof(T)));
+            f.write((const char*)zero.data(), t * sizeof(T));
+        }
+        f.flush();
+        if (!f)
+            throw std::runtime_error("Cannot write tiled matrix file " + path);
+    }
+    TTiledFile(const TTiledFile&) = delete;
+    TTiledFile& operator=(const TTiledFile&) = delete;
+
+    size_t size() const noexcept { return (size_t)n; }
+    size_t tile() const noexcept { return (size_t)t; }
+    size_t tiles() const noexcept { return (size_t)cnt; }
+
+    void read_tile(size_t i, size_t j, TDynamicMatrix<T>& m) const
+    {
+        check_tile(m);
+        uint64_t off = offset(i, j);
+        std::lock_guard<std::mutex> lk(mtx);
+        f.seekg((std::streamoff)off);
+        for (size_t r = 0; r < t; r++)
+            f.read((char*)m[r].data(), t * sizeof(T));
+        if (!f)
+            throw std::runtime_error("Cannot read tile");
+    }
+    TDynamicMatrix<T> read_tile(size_t i, size_t j) const
+    {
+        TDynamicMatrix<T> m(t);
+        read_tile(i, j, m);
+        return m;
+    }
+    void write_tile(size_t i, size_t j, const TDynamicMatrix<T>& m)
+    {
+        check_tile(m);
+        uint64_t off = offset(i, j);
+        std::lock_guard<std::mutex> lk(mtx);
+        f.seekp((std::streamoff)off);
+        for (size_t r = 0; r < t; r++)
+            f.write((const char*)m[r].data(), t * sizeof(T));
+        f.flush();
+        if (!f)
+            throw std::runtime_error("Cannot write tile");
+    }
+
+    // перенос матрицы, помещающейся в память, в файл и обратно
+    void assign(const TDynamicMatrix<T>& m)
+    {
+        if (m.size() != n)
+            throw std::invalid_argument("Matrix size should match the file");
+        TDynamicMatrix<T> tl(t);
+        for (size_t i = 0; i < cnt; i++)
+            for (size_t j = 0; j < cnt; j++) {
+                for (size_t r = 0; r < t; r++)
+                    for (size_t c = 0; c < t; c++) {
+                        size_t gr = i * t + r, gc = j * t + c;
+                        tl[r][c] = gr < n && gc < n ? m[gr][gc] : T();
+                    }
+                write_tile(i, j, tl);
+            }
+    }
+    TDynamicMatrix<T> to_matrix() const
+    {
+        if (n >= (uint64_t)MAX_MATRIX_SIZE)
+            throw std::out_of_range("Matrix is too large to load into memory");
+        TDynamicMatrix<T> m((size_t)n), tl(t);
+        for (size_t i = 0; i < cnt; i++)
+            for (size_t j = 0; j < cnt; j++) {
+                read_tile(i, j, tl);
+                for (size_t r = 0; r < t && i * t + r < n; r++)
+                    for (size_t c = 0; c < t && j * t + c < n; c++)
+                        m[i * t + r][j * t + c] = tl[r][c];
+            }
+        return m;
+    }
+};
+
+// Объем ввода-вывода умножения в плитках
+struct TOutOfCoreStats
+{
+    size_t block;           // сторона блока C в плитках, который держится в памяти
+    size_t tile_reads;
+    size_t tile_writes;
+};
+
+// C = A B вне оперативной памяти. C обходится квадратными блоками q x q плиток,
+// которые накапливаются в памяти; для блока по k читаются панели
+// A(I.., k) и B(k, J..) из q плиток. Каждая плитка C пишется один раз, а A и B
+// читаются 2 nt^3 / q раз вместо 2 nt^3 у поплиточного порядка, где nt - число
+// плиток в строке. q выбирается наибольшим по бюджету памяти memory_bytes:
+// два блока C (текущий и записываемый), две пары панелей (текущая и
+// читаемая заранее) и произведение плиток. Порядок k меняется на обратный у каждого следующего блока,
+// и первая панель A при том же I совпадает с последней - она не перечитывается.
+// Следующая панель читается в пуле потоков, пока умножается текущая, а готовый
+// блок C записывается, пока считается следующий
+template<typename T>
+TOutOfCoreStats out_of_core_multiply(const TTiledFile<T>& a, const TTiledFile<T>& b, TTiledFile<T>& c, size_t memory_bytes)
+{
+    typedef std::shared_ptr<const TDynamicMatrix<T>> TTile;
+    struct TPanel
+    {
+        size_t k;
+        std::vector<TTile> a, b;
+    };
+    typedef std::shared_ptr<TPanel> TPanelPtr;
+
+    if (a.size() != b.size() || a.size() != c.size() || a.tile() != b.tile() || a.tile() != c.tile())
+        throw std::invalid_argument("Tiled matrices should have the same size and tile");
+    const size_t t = a.tile(), nt = a.tiles();
+    TOutOfCoreStats st = { 0, 0, 0 };
+    if (nt == 0)
+        return st;
+    const size_t budget = memory_bytes / (t * t * sizeof(T));
+    size_t q = 0;
+    while (q < nt && 2 * (q + 1) * (q + 1) + 4 * (q + 1) + 1 <= budget)
+        q++;
+    if (q == 0)
+        throw std::invalid_argument("Memory budget should hold at least seven tiles");
+    st.block = q;
+
+    // порядок блоков и панелей: (I, J, k) для каждого шага
+    struct TStep
+    {
+        size_t bi, bj, k;
+    };
+    std::vector<TStep> steps;
+    bool forward = true;
+    for (size_t bi = 0; bi < nt; bi += q) {
+        for (size_t bj = 0; bj < nt; bj += q) {
+            for (size_t s = 0; s < nt; s++)
+                steps.push_back({ bi, bj, forward ? s : nt - 1 - s });
+            forward = !forward;
+        }
+    }
+
+    // панель шага s; плитки A берутся из предыдущей панели, если совпадают I и k
+    auto load = [&a, &b, t, nt, q](const TStep& s, const TPanelPtr& prev, bool reuse_a) {
+        TPanelPtr p = std::make_shared<TPanel>();
+        p->k = s.k;
+        size_t ri = std::min(q, nt - s.bi), cj = std::min(q, nt - s.bj);
+        if (reuse_a)
+            p->a = prev->a;
+        else
+            for (size_t i = 0; i < ri; i++)
+                p->a.push_back(std::make_shared<const TDynamicMatrix<T>>(a.read_tile(s.bi + i, s.k)));
+        for (size_t j = 0; j < cj; j++)
+            p->b.push_back(std::make_shared<const TDynamicMatrix<T>>(b.read_tile(s.k, s.bj + j)));
+        return p;
+    };
+    auto reuses = [&steps](size_t s) {
+        return s > 0 && steps[s - 1].bi == steps[s].bi && steps[s - 1].k == steps[s].k;
+    };
+    auto count_reads = [&](size_t s) {
+        st.tile_reads += std::min(q, nt - steps[s].bj);
+        if (!reuses(s))
+            st.tile_reads += std::min(q, nt - steps[s].bi);
+    };
+
+    std::vector<TDynamicMatrix<T>> acc;
+    TFuture<int> store;
+    TFuture<TPanelPtr> next;
+    TPanelPtr cur = load(steps[0], nullptr, false);
+    count_reads(0);
+    try {
+        for (size_t s = 0; s < steps.size(); s++) {
+            const TStep& step = steps[s];
+            size_t ri = std::min(q, nt - step.bi), cj = std::min(q, nt - step.bj);
+            next = TFuture<TPanelPtr>();
+            if (s + 1 < steps.size()) {
+                bool r = reuses(s + 1);
+                TStep ns = steps[s + 1];
+                next = async_run([load, ns, cur, r]() { return load(ns, cur, r); });
+                count_reads(s + 1);
+            }
+            if (acc.empty())
+                acc.assign(ri * cj, TDynamicMatrix<T>(t));
+            for (size_t i = 0; i < ri; i++)
+                for (size_t j = 0; j < cj; j++) {
+                    TDynamicMatrix<T> prod = *cur->a[i] * *cur->b[j];
+                    TDynamicMatrix<T>& dst = acc[i * cj + j];
+                    for (size_t r = 0; r < t; r++) {
+                        T* pd = dst[r].data();
+                        const T* pp = prod[r].data();
+                        for (size_t l = 0; l < t; l++)
+                            pd[l] += pp[l];
+                    }
+                }
+            // блок C готов после последней панели: запись идет в фоне, но не больше одной
+            if (s + 1 == steps.size() || steps[s + 1].bi != step.bi || steps[s + 1].bj != step.bj) {
+                if (store.valid())
+                    store.get();
+                auto done = std::make_shared<std::vector<TDynamicMatrix<T>>>(std::move(acc));
+                acc.clear();
+                TTiledFile<T>* pc = &c;
+                size_t bi = step.bi, bj = step.bj;
+                store = async_run([done, pc, bi, bj, cj]() {
+                    for (size_t i = 0; i < done->size(); i++)
+                        pc->write_tile(bi + i / cj, bj + i % cj, (*done)[i]);
+                    return 0;
+                });
+                st.tile_writes += ri * cj;
+            }
+            if (next.valid())
+                cur = next.get();
+        }
+        store.get();
+    }
+    catch (...) {
+        // фоновые чтение и запись обращаются к файлам - дожидаемся их до выхода
+        if (next.valid())
+            next.wait();
+        if (store.valid())
+            store.wait();
+        throw;
+    }
+    return st;
+}
+
+#endif
@@ -0,0 +1,333 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Пул потоков и параллельные циклы для ядер матричных операций
+
+#ifndef __TParallel_H__
+#define __TParallel_H__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "tmetrics.h"
+#include "tnuma.h"
+#include "tperfcounters.h"
+#include "ttrace.h"
+
+// Пул потоков библиотеки -
+// общая очередь задач, ожидающие потоки помогают её разбирать.
+// У каждого потока есть и своя очередь для задач, которые должен выполнить
+// именно он (submit_to). На машине с несколькими узлами NUMA при политике
+// размещения, отличной от local, потоки привязаны к узлам, и такие задачи
+// работают с памятью своего узла
+class TThreadPool
+{
+    static constexpr size_t NONE = size_t(-1);
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::deque<std::function<void()>>> local;
+    std::mutex mtx;
+    std::condition_variable cv;
+    bool stop;
+
+    explicit TThreadPool(size_t n) : local(n), stop(false)
+    {
+        for (size_t i = 0; i < n; i++)
+            workers.emplace_back([this, i, n]() {
+                self() = i;
+                loop(i, n);
+            });
+    }
+    // привязка потока w к узлу следует за политикой: она может смениться
+    // после создания пула, поэтому проверяется перед каждой задачей
+    static void place(size_t w, size_t n, bool& pinned)
+    {
+        bool want = TNumaConfig::policy() != TNumaPolicy::local && TNuma::nodes() > 1;
+        if (want == pinned)
+            return;
+        pinned = want;
+        if (want)
+            TNuma::bind_thread(TNuma::node_of_worker(w, n));
+        else
+            TNuma::unbind_thread();
+    }
+    // номер потока пула, выполняющего код, или NONE
+    static size_t& self()
+    {
+        thread_local size_t id = NONE;
+        return id;
+    }
+    // задача для потока w: сначала своя очередь, потом общая; под mtx
+    bool take(size_t w, std::function<void()>& task)
+    {
+        if (w != NONE && !local[w].empty()) {
+            task = std::move(local[w].front());
+            local[w].pop_front();
+            return true;
+        }
+        if (!tasks.empty()) {
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
+    void loop(size_t w, size_t n)
+    {
+        bool pinned = false;
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                cv.wait(lk, [this, w]() { return stop || !tasks.empty() || !local[w].empty(); });
+                if (!take(w, task))
+                    return;
+            }
+            place(w, n, pinned);
+            task();
+        }
+    }
+public:
+    TThreadPool(const TThreadPool&) = delete;
+    TThreadPool& operator=(const TThreadPool&) = delete;
+    ~TThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto& w : workers)
+            w.join();
+    }
+
+    static TThreadPool& instance()
+    {
+        static TThreadPool pool(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() : 1);
+        return pool;
+    }
+
+    size_t threads() const noexcept { return workers.size(); }
+
+    void submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            tasks.push_back(std::move(task));
+        }
+        cv.notify_one();
+    }
+    // задача для потока worker (по модулю числа потоков); без потоков - в общую очередь
+    void submit_to(size_t worker, std::function<void()> task)
+    {
+        if (workers.empty()) {
+            submit(std::move(task));
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            local[worker % workers.size()].push_back(std::move(task));
+        }
+        // будим всех: notify_one мог бы разбудить не тот поток
+        cv.notify_all();
+    }
+
+    // выполнить одну задачу в текущем потоке: поток пула берет и свои задачи,
+    // поэтому ожидание внутри задачи не блокирует адресованные ему задачи
+    bool run_pending()
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            if (!take(self(), task))
+                return false;
+        }
+        task();
+        return true;
+    }
+};
+
+// Группа задач - запуск в пуле и ожидание завершения всех;
+// первое исключение пробрасывается из wait()
+class TTaskGroup
+{
+    static constexpr size_t NONE = size_t(-1);
+
+    std::atomic<size_t> pending;
+    std::exception_ptr error;
+    std::mutex mtx;
+    std::condition_variable cv;
+public:
+    TTaskGroup() : pending(0) {}
+    TTaskGroup(const TTaskGroup&) = delete;
+    TTaskGroup& operator=(const TTaskGroup&) = delete;
+    ~TTaskGroup()
+    {
+        try { wait(); }
+        catch (...) {}
+    }
+
+    void run(std::function<void()> f)
+    {
+        run_on(NONE, std::move(f));
+    }
+    // задача для потока пула worker; NONE - любой поток
+    void run_on(size_t worker, std::function<void()> f)
+    {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        auto task = [this, f = std::move(f) TMATRIX_PERF_CAPTURE TMATRIX_METRIC_CAPTURE]() {
+            try {
+                TMATRIX_PERF_TASK();
+                TMATRIX_METRIC_TASK();
+                TMATRIX_TRACE_SCOPE("task");
+                f();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lk(mtx);
+                if (!error)
+                    error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lk(mtx);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                cv.notify_all();
+        };
+        if (worker == NONE)
+            TThreadPool::instance().submit(std::move(task));
+        else
+            TThreadPool::instance().submit_to(worker, std::move(task));
+    }
+
+    void wait()
+    {
+        TMATRIX_TRACE_SCOPE("wait");
+        // пока ждем - помогаем пулу, иначе вложенный параллелизм может зависнуть
+        while (pending.load(std::memory_order_acquire) != 0) {
+            if (TThreadPool::instance().run_pending())
+                continue;
+            std::unique_lock<std::mutex> lk(mtx);
+            cv.wait_for(lk, std::chrono::microseconds(200),
+                [this]() { return pending.load(std::memory_order_acquire) == 0; });
+        }
+        std::lock_guard<std::mutex> lk(mtx);
+        if (error) {
+            std::exception_ptr e = error;
+            error = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
+};
+
+// Режим выполнения поэлементных операций над векторами
+enum class TExecMode
+{
+    sequential,
+    parallel,
+    automatic   // параллельно, начиная с порога
+};
+
+struct TParallelConfig
+{
+    static TExecMode& mode()
+    {
+        static TExecMode m = TExecMode::automatic;
+        return m;
+    }
+    // порог в элементах для режима automatic
+    static size_t& threshold()
+    {
+        static size_t t = size_t(1) << 18;
+        return t;
+    }
+    static bool use_parallel(size_t n)
+    {
+        return mode() == TExecMode::parallel
+            || (mode() == TExecMode::automatic && n >= threshold());
+    }
+    // куски параллельных циклов закреплены за потоками пула: кусок c выполняет
+    // поток c - 1, кусок 0 - вызывающий. Включено при размещении first_touch,
+    // чтобы ядра работали с теми страницами, которые этот поток заполнил
+    static bool node_affine()
+    {
+        return TNumaConfig::policy() == TNumaPolicy::first_touch;
+    }
+};
+
+// Параллельный цикл по [begin, end) - диапазон режется на непрерывные
+// куски не меньше grain, f(b, e) вызывается для каждого куска
+template<typename F>
+void parallel_for(size_t begin, size_t end, size_t grain, F&& f)
+{
+    if (end <= begin)
+        return;
+    size_t n = end - begin;
+    size_t workers = TThreadPool::instance().threads() + 1;
+    if (grain == 0)
+        grain = 1;
+    size_t chunks = (n + grain - 1) / grain;
+    if (chunks > workers)
+        chunks = workers;
+    if (chunks <= 1) {
+        f(begin, end);
+        return;
+    }
+    TMATRIX_TRACE_SCOPE("parallel_for");
+    size_t step = n / chunks, rest = n % chunks;
+    bool affine = TParallelConfig::node_affine();
+    TTaskGroup group;
+    size_t b = begin + step + (rest > 0 ? 1 : 0);
+    for (size_t c = 1; c < chunks; c++) {
+        size_t e = b + step + (c < rest ? 1 : 0);
+        if (affine)
+            group.run_on(c - 1, [&f, b, e]() { f(b, e); });
+        else
+            group.run([&f, b, e]() { f(b, e); });
+        b = e;
+    }
+    f(begin, begin + step + (rest > 0 ? 1 : 0));
+    group.wait();
+}
+
+// Параллельный цикл с границами кусков, кратными align элементам: если
+// массив выровнен по странице, а align - число элементов в странице, куски
+// не делят страниц. При одном числе потоков границы кусков всегда одни и те
+// же, а при node_affine() кусок всегда достается одному и тому же потоку.
+// Локальность по NUMA есть, только если этот поток и коснулся страниц
+// первым - при политике first_touch, когда так заполняется и сам массив
+template<typename F>
+void parallel_for_aligned(size_t n, size_t align, F&& f)
+{
+    size_t workers = TThreadPool::instance().threads() + 1;
+    if (align == 0)
+        align = 1;
+    size_t units = (n + align - 1) / align;
+    if (workers > units)
+        workers = units;
+    if (workers <= 1) {
+        f(size_t(0), n);
+        return;
+    }
+    TMATRIX_TRACE_SCOPE("parallel_for");
+    bool affine = TParallelConfig::node_affine();
+    TTaskGroup group;
+    for (size_t w = 1; w < workers; w++) {
+        size_t b = std::min(n, units * w / workers * align);
+        size_t e = std::min(n, units * (w + 1) / workers * align);
+        if (b >= e)
+            continue;
+        if (affine)
+            group.run_on(w - 1, [&f, b, e]() { f(b, e); });
+        else
+            group.run([&f, b, e]() { f(b, e); });
+    }
+    f(size_t(0), std::min(n, units / workers * align));
+    group.wait();
+}
+
+#endif
@@ -0,0 +1,341 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Аппаратные счетчики производительности для ядер (Linux perf_event_open)
+
+#ifndef __TPerfCounters_H__
+#define __TPerfCounters_H__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Измеряемые события
+struct TPerfEvent
+{
+    enum
+    {
+        cycles,
+        instructions,
+        llc_misses,     // промахи последнего уровня кэша при чтении
+        dtlb_misses,    // промахи TLB данных при чтении
+        branch_misses,
+        COUNT
+    };
+    static const char* name(size_t e) noexcept
+    {
+        static const char* names[COUNT] = { "cycles", "instructions", "llc_misses", "dtlb_misses", "branch_misses" };
+        return names[e];
+    }
+};
+
+// Накопленные значения по одному типу операций
+struct TPerfTotals
+{
+    size_t calls = 0;
+    double seconds = 0.0;
+    uint64_t values[TPerfEvent::COUNT] = {};
+    bool valid[TPerfEvent::COUNT] = {};   // событие поддерживается и было прочитано
+};
+
+// Группа счетчиков текущего потока: открывается один раз и считает постоянно,
+// области измерения читают значения в начале и в конце.
+// Если perf_event_open недоступен (не Linux, perf_event_paranoid, виртуальная машина),
+// группа пуста и измеряется только время
+class TPerfGroup
+{
+    int fds[TPerfEvent::COUNT];
+    uint64_t ids[TPerfEvent::COUNT];
+    int leader;
+
+#if defined(__linux__)
+    static int open_event(uint32_t type, uint64_t config, int group) noexcept
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+        return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+    }
+    static uint64_t cache_event(uint64_t cache) noexcept
+    {
+        return cache | ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ << 8) | ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    }
+#endif
+
+    TPerfGroup() : leader(-1)
+    {
+        for (size_t e = 0; e < TPerfEvent::COUNT; e++) {
+            fds[e] = -1;
+            ids[e] = 0;
+        }
+#if defined(__linux__)
+        const uint32_t types[TPerfEvent::COUNT] = { PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+            PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE, PERF_TYPE_HARDWARE };
+        const uint64_t configs[TPerfEvent::COUNT] = { PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            cache_event(PERF_COUNT_HW_CACHE_LL), cache_event(PERF_COUNT_HW_CACHE_DTLB), PERF_COUNT_HW_BRANCH_MISSES };
+        // первое открывшееся событие становится лидером группы,
+        // неподдерживаемые события пропускаются
+        for (size_t e = 0; e < TPerfEvent::COUNT; e++) {
+            fds[e] = open_event(types[e], configs[e], leader);
+            if (fds[e] < 0)
+                continue;
+            if (leader < 0)
+                leader = fds[e];
+            if (ioctl(fds[e], PERF_EVENT_IOC_ID, &ids[e]) != 0) {
+                close(fds[e]);
+                fds[e] = -1;
+            }
+        }
+#endif
+    }
+public:
+    TPerfGroup(const TPerfGroup&) = delete;
+    TPerfGroup& operator=(const TPerfGroup&) = delete;
+    ~TPerfGroup()
+    {
+#if defined(__linux__)
+        // лидер закрывается последним
+        for (size_t e = TPerfEvent::COUNT; e-- > 0;)
+            if (fds[e] >= 0 && fds[e] != leader)
+                close(fds[e]);
+        if (leader >= 0)
+            close(leader);
+#endif
+    }
+
+    static TPerfGroup& local()
+    {
+        thread_local TPerfGroup g;
+        return g;
+    }
+
+    bool available() const noexcept { return leader >= 0; }
+
+    // текущие значения; valid[e] = false для неоткрытых событий
+    void read(uint64_t* values, bool* valid) const noexcept
+    {
+        for (size_t e = 0; e < TPerfEvent::COUNT; e++) {
+            values[e] = 0;
+            valid[e] = false;
+        }
+#if defined(__linux__)
+        if (leader < 0)
+            return;
+        // формат PERF_FORMAT_GROUP | PERF_FORMAT_ID: nr, затем пары (value, id)
+        uint64_t buf[1 + 2 * TPerfEvent::COUNT];
+        if (::read(leader, buf, sizeof(buf)) < (ssize_t)sizeof(uint64_t))
+            return;
+        for (uint64_t k = 0; k < buf[0] && k < TPerfEvent::COUNT; k++)
+            for (size_t e = 0; e < TPerfEvent::COUNT; e++)
+                if (fds[e] >= 0 && ids[e] == buf[2 + 2 * k]) {
+                    values[e] = buf[1 + 2 * k];
+                    valid[e] = true;
+                }
+#endif
+    }
+};
+
+// Сводка по операциям, общая для всех потоков
+class TPerfCounters
+{
+    std::map<std::string, TPerfTotals> totals;
+    mutable std::mutex mtx;
+public:
+    static TPerfCounters& instance()
+    {
+        static TPerfCounters c;
+        return c;
+    }
+
+    // счетчики открываются в текущем потоке
+    static bool available() { return TPerfGroup::local().available(); }
+
+    void add(const char* op, double seconds, const uint64_t* values, const bool* valid)
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        TPerfTotals& t = totals[op];
+        t.calls++;
+        t.seconds += seconds;
+        for (size_t e = 0; e < TPerfEvent::COUNT; e++)
+            if (valid[e]) {
+                t.values[e] += values[e];
+                t.valid[e] = true;
+            }
+    }
+
+    std::vector<std::pair<std::string, TPerfTotals>> report() const
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        return std::vector<std::pair<std::string, TPerfTotals>>(totals.begin(), totals.end());
+    }
+    void reset()
+    {
+        std::lock_guard<std::mutex> lk(mtx);
+        totals.clear();
+    }
+
+    // {"gemm": {"calls": 1, "seconds": 0.01, "cycles": 123, ...}, ...};
+    // неподдерживаемые события выводятся как null
+    void dump_json(std::ostream& os) const
+    {
+        auto r = report();
+        os << "{";
+        for (size_t i = 0; i < r.size(); i++) {
+            const TPerfTotals& t = r[i].second;
+            os << (i ? ", " : "") << "\"" << r[i].first << "\": {\"calls\": " << t.calls
+               << ", \"seconds\": " << t.seconds;
+            for (size_t e = 0; e < TPerfEvent::COUNT; e++) {
+                os << ", \"" << TPerfEvent::name(e) << "\": ";
+                if (t.valid[e])
+                    os << t.values[e];
+                else
+                    os << "null";
+            }
+            os << "}";
+        }
+        os << "}";
+    }
+};
+
+// Значения области измерения, которые добавляют задачи пула: задача,
+// запущенная внутри области, считает в своем потоке и прибавляет разность сюда
+struct TPerfShared
+{
+    std::atomic<uint64_t> values[TPerfEvent::COUNT] = {};
+    std::atomic<bool> valid[TPerfEvent::COUNT] = {};
+};
+
+// Область измерения: разность счетчиков и время от создания до разрушения
+// добавляются к операции op. Записывается только внешняя область потока:
+// вложенные (dot внутри gemv) не считаются второй раз и не тратят на себя
+// системные вызовы. Работа потоков пула, запущенная внутри области через
+// TTaskGroup, входит в ее счетчики (см. TPerfTask)
+class TPerfScope
+{
+    friend class TPerfTask;
+
+    const char* op;
+    bool outer;
+    std::shared_ptr<TPerfShared> shared;
+    uint64_t start[TPerfEvent::COUNT];
+    bool valid[TPerfEvent::COUNT];
+    std::chrono::steady_clock::time_point t0;
+
+    // глубина вложения областей и задач в текущем потоке
+    static size_t& depth() noexcept
+    {
+        thread_local size_t d = 0;
+        return d;
+    }
+public:
+    // область, в счет которой работает текущий поток, или пусто
+    static std::shared_ptr<TPerfShared>& active() noexcept
+    {
+        thread_local std::shared_ptr<TPerfShared> a;
+        return a;
+    }
+
+    explicit TPerfScope(const char* name) : op(name), outer(depth()++ == 0)
+    {
+        if (!outer)
+            return;
+        shared = std::make_shared<TPerfShared>();
+        active() = shared;
+        TPerfGroup::local().read(start, valid);
+        t0 = std::chrono::steady_clock::now();
+    }
+    TPerfScope(const TPerfScope&) = delete;
+    TPerfScope& operator=(const TPerfScope&) = delete;
+    ~TPerfScope()
+    {
+        depth()--;
+        if (!outer)
+            return;
+        double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        uint64_t end[TPerfEvent::COUNT];
+        bool ok[TPerfEvent::COUNT];
+        TPerfGroup::local().read(end, ok);
+        active().reset();
+        for (size_t e = 0; e < TPerfEvent::COUNT; e++) {
+            ok[e] = ok[e] && valid[e];
+            end[e] = ok[e] ? end[e] - start[e] : 0;
+            if (shared->valid[e].load(std::memory_order_acquire)) {
+                end[e] += shared->values[e].load(std::memory_order_relaxed);
+                ok[e] = true;
+            }
+        }
+        TPerfCounters::instance().add(op, sec, end, ok);
+    }
+};
+
+// Задача пула, запущенная внутри области acc: разность счетчиков потока пула
+// за время задачи добавляется к области, области внутри задачи не записываются.
+// Если поток сам уже внутри области (ожидающий поток помогает пулу), его
+// счетчики и так идут в ту область и второй раз не добавляются
+class TPerfTask
+{
+    std::shared_ptr<TPerfShared> acc;
+    uint64_t start[TPerfEvent::COUNT];
+    bool valid[TPerfEvent::COUNT];
+public:
+    explicit TPerfTask(const std::shared_ptr<TPerfShared>& a)
+    {
+        if (!a || TPerfScope::depth() != 0)
+            return;
+        acc = a;
+        TPerfScope::depth()++;
+        TPerfScope::active() = acc;
+        TPerfGroup::local().read(start, valid);
+    }
+    TPerfTask(const TPerfTask&) = delete;
+    TPerfTask& operator=(const TPerfTask&) = delete;
+    ~TPerfTask()
+    {
+        if (!acc)
+            return;
+        uint64_t end[TPerfEvent::COUNT];
+        bool ok[TPerfEvent::COUNT];
+        TPerfGroup::local().read(end, ok);
+        for (size_t e = 0; e < TPerfEvent::COUNT; e++)
+            if (ok[e] && valid[e]) {
+                acc->values[e].fetch_add(end[e] - start[e], std::memory_order_relaxed);
+                acc->valid[e].store(true, std::memory_order_release);
+            }
+        TPerfScope::active().reset();
+        TPerfScope::depth()--;
+    }
+};
+
+// Ядра размечаются этим макросом; без TMATRIX_ENABLE_PERF_COUNTERS он пуст
+// TMATRIX_PERF_CAPTURE добавляется в список захвата задачи пула,
+// TMATRIX_PERF_TASK() в ее начало - так задача считает в счет области
+#if defined(TMATRIX_ENABLE_PERF_COUNTERS)
+#define TMATRIX_PERF_SCOPE(op) TPerfScope tmatrix_perf_scope_(op)
+#define TMATRIX_PERF_CAPTURE , tmatrix_perf_ = TPerfScope::active()
+#define TMATRIX_PERF_TASK() TPerfTask tmatrix_perf_task_(tmatrix_perf_)
+#else
+#define TMATRIX_PERF_SCOPE(op)
+#define TMATRIX_PERF_CAPTURE
+#define TMATRIX_PERF_TASK()
+#endif
+
+#endif
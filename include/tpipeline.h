@@ -0,0 +1,265 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Потоковая обработка матрицы блоками строк на сопрограммах C++20
+
+#ifndef __TPipeline_H__
+#define __TPipeline_H__
+
+#if !defined(__cpp_impl_coroutine)
+#error "tpipeline.h requires C++20 coroutines (e.g. -std=c++20 or /std:c++20)"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "tasync.h"
+#include "telementwise.h"
+#include "tmatrix.h"
+
+// Ленивая последовательность значений: сопрограмма выполняется до следующего
+// co_yield при каждом next(). Исключение сопрограммы выбрасывается из next()
+template<typename V>
+class TGenerator
+{
+public:
+    struct promise_type
+    {
+        std::unique_ptr<V> value;
+        std::exception_ptr error;
+
+        TGenerator get_return_object() { return TGenerator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        std::suspend_always yield_value(V v)
+        {
+            value.reset(new V(std::move(v)));
+            return {};
+        }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    class iterator
+    {
+        TGenerator* g;
+    public:
+        explicit iterator(TGenerator* gen) : g(gen) {}
+        V& operator*() const { return g->value(); }
+        iterator& operator++()
+        {
+            if (!g->next())
+                g = nullptr;
+            return *this;
+        }
+        bool operator==(const iterator& it) const noexcept { return g == it.g; }
+        bool operator!=(const iterator& it) const noexcept { return g != it.g; }
+    };
+private:
+    std::coroutine_handle<promise_type> h;
+
+    explicit TGenerator(std::coroutine_handle<promise_type> c) : h(c) {}
+public:
+    TGenerator(const TGenerator&) = delete;
+    TGenerator& operator=(const TGenerator&) = delete;
+    TGenerator(TGenerator&& g) noexcept : h(g.h) { g.h = nullptr; }
+    TGenerator& operator=(TGenerator&& g) noexcept
+    {
+        if (this != &g) {
+            if (h)
+                h.destroy();
+            h = g.h;
+            g.h = nullptr;
+        }
+        return *this;
+    }
+    ~TGenerator()
+    {
+        if (h)
+            h.destroy();
+    }
+
+    // переход к следующему значению; false - последовательность закончилась
+    bool next()
+    {
+        if (!h || h.done())
+            return false;
+        h.resume();
+        if (h.promise().error) {
+            std::exception_ptr e = h.promise().error;
+            h.promise().error = nullptr;
+            std::rethrow_exception(e);
+        }
+        return !h.done();
+    }
+    V& value() const { return *h.promise().value; }
+
+    iterator begin() { return iterator(next() ? this : nullptr); }
+    iterator end() noexcept { return iterator(nullptr); }
+};
+
+// Блок подряд идущих строк матрицы n x n начиная со строки first
+template<typename T>
+struct TRowBlock
+{
+    size_t first;
+    std::vector<TDynamicVector<T>> rows;
+};
+
+// Часть вектора-результата начиная с элемента first
+template<typename T>
+struct TVectorChunk
+{
+    size_t first;
+    TDynamicVector<T> values;
+};
+
+// Источник, стадии и приемники конвейера. Стадии - сопрограммы, которые берут
+// блоки у предыдущей стадии по одному, поэтому в памяти находятся только
+// блоки в обработке и в буфере prefetch. Аргументы передаются по значению,
+// кроме потоков ввода-вывода: они должны жить, пока работает конвейер.
+// Класс со статическими методами, как TElementwise: имена map и read свободны
+class TPipeline
+{
+public:
+    // Матрица n x n в текстовом формате operator>> блоками по rows строк
+    template<typename T>
+    static TGenerator<TRowBlock<T>> read(std::istream& in, size_t n, size_t rows)
+    {
+        if (rows == 0)
+            throw std::invalid_argument("Block must contain at least one row");
+        for (size_t first = 0; first < n; first += rows) {
+            TRowBlock<T> b{ first, {} };
+            size_t cnt = std::min(rows, n - first);
+            b.rows.reserve(cnt);
+            for (size_t r = 0; r < cnt; r++) {
+                TDynamicVector<T> row(n);
+                if (!(in >> row))
+                    throw std::runtime_error("Invalid matrix data in stream");
+                b.rows.push_back(std::move(row));
+            }
+            co_yield std::move(b);
+        }
+    }
+
+    // Чтение вперед: до depth следующих значений вычисляются в пуле потоков,
+    // пока потребитель обрабатывает текущее. Буфер ограничен - если потребитель
+    // отстает, источник не запрашивается дальше depth значений
+    template<typename V>
+    static TGenerator<V> prefetch(TGenerator<V> src, size_t depth)
+    {
+        typedef std::shared_ptr<V> TItem;
+        if (depth == 0)
+            depth = 1;
+        // запросы к источнику образуют цепочку и выполняются строго по очереди
+        std::shared_ptr<TGenerator<V>> up = std::make_shared<TGenerator<V>>(std::move(src));
+        std::shared_ptr<std::atomic<bool>> stop = std::make_shared<std::atomic<bool>>(false);
+        auto pull = [up, stop]() {
+            if (stop->load(std::memory_order_acquire) || !up->next())
+                return TItem();
+            return std::make_shared<V>(std::move(up->value()));
+        };
+        std::deque<TFuture<TItem>> ahead;
+        // если потребитель бросил конвейер раньше конца, запросы после этого
+        // не читают источник, а уже идущие дожидаются: источник может
+        // ссылаться на поток, который разрушится после конвейера
+        struct TStop
+        {
+            std::atomic<bool>& stop;
+            std::deque<TFuture<TItem>>& ahead;
+            ~TStop()
+            {
+                stop.store(true, std::memory_order_release);
+                for (const TFuture<TItem>& f : ahead)
+                    f.wait();
+            }
+        } guard{ *stop, ahead };
+        TFuture<TItem> last = async_run(pull);
+        ahead.push_back(last);
+        for (;;) {
+            while (ahead.size() < depth) {
+                last = last.then([pull](const TItem& prev) { return prev ? pull() : TItem(); });
+                ahead.push_back(last);
+            }
+            TItem item = ahead.front().get();
+            ahead.pop_front();
+            if (!item)
+                break;
+            co_yield std::move(*item);
+        }
+    }
+
+    // y = A x по блокам строк A
+    template<typename T>
+    static TGenerator<TVectorChunk<T>> gemv(TGenerator<TRowBlock<T>> src, TDynamicVector<T> x)
+    {
+        while (src.next()) {
+            const TRowBlock<T>& b = src.value();
+            TVectorChunk<T> c{ b.first, TDynamicVector<T>(b.rows.size()) };
+            for (size_t r = 0; r < b.rows.size(); r++)
+                c.values[r] = b.rows[r] * x;
+            co_yield std::move(c);
+        }
+    }
+
+    // поэлементное f над каждым блоком
+    template<typename T, typename F>
+    static TGenerator<TRowBlock<T>> map(TGenerator<TRowBlock<T>> src, F f)
+    {
+        while (src.next()) {
+            TRowBlock<T>& b = src.value();
+            for (TDynamicVector<T>& row : b.rows)
+                row = TElementwise::map(row, f);
+            co_yield std::move(b);
+        }
+    }
+
+    template<typename T>
+    static TGenerator<TRowBlock<T>> scale(TGenerator<TRowBlock<T>> src, T alpha)
+    {
+        while (src.next()) {
+            TRowBlock<T>& b = src.value();
+            for (TDynamicVector<T>& row : b.rows)
+                row = row * alpha;
+            co_yield std::move(b);
+        }
+    }
+
+    // Приемник: строки в формате operator<< для матрицы; возвращает число строк
+    template<typename T>
+    static size_t write(TGenerator<TRowBlock<T>> src, std::ostream& out)
+    {
+        size_t cnt = 0;
+        while (src.next()) {
+            for (const TDynamicVector<T>& row : src.value().rows) {
+                for (size_t j = 0; j < row.size(); j++)
+                    out << row[j] << " ";
+                out << "\n";
+            }
+            cnt += src.value().rows.size();
+        }
+        return cnt;
+    }
+
+    // Приемник частей вектора в y
+    template<typename T>
+    static void collect(TGenerator<TVectorChunk<T>> src, TDynamicVector<T>& y)
+    {
+        while (src.next()) {
+            const TVectorChunk<T>& c = src.value();
+            if (c.first + c.values.size() > y.size())
+                throw std::out_of_range("Chunk is out of the result vector");
+            for (size_t i = 0; i < c.values.size(); i++)
+                y[c.first + i] = c.values[i];
+        }
+    }
+};
+
+#endif
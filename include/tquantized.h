@@ -0,0 +1,223 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Квантованные int8-матрицы и умножение с накоплением в int32
+
+#ifndef __TQuantized_H__
+#define __TQuantized_H__
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "tmatrix.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Ядро скалярного произведения int8-векторов длины n (n кратно 32)
+struct TInt8Dot
+{
+    static constexpr size_t ALIGN = 32;
+
+#if defined(__AVX2__)
+    static int32_t hsum(__m256i v) noexcept
+    {
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4e));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xb1));
+        return _mm_cvtsi128_si32(s);
+    }
+#endif
+
+    // точная сумма a[k] * b[k]
+    static int32_t dot(const int8_t* a, const int8_t* b, size_t n) noexcept
+    {
+#if defined(__AVXVNNI__) || (defined(__AVX512VNNI__) && defined(__AVX512VL__))
+        // vpdpbusd умножает беззнаковые байты на знаковые: a + 128 >= 0,
+        // лишнее слагаемое 128 * sum(b) вычитается в конце
+        const __m256i bias = _mm256_set1_epi8((char)0x80);
+        const __m256i ones = _mm256_set1_epi8(1);
+        __m256i acc = _mm256_setzero_si256(), bsum = _mm256_setzero_si256();
+        for (size_t k = 0; k < n; k += 32) {
+            __m256i va = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + k)), bias);
+            __m256i vb = _mm256_loadu_si256((const __m256i*)(b + k));
+#if defined(__AVXVNNI__)
+            acc = _mm256_dpbusd_avx_epi32(acc, va, vb);
+            bsum = _mm256_dpbusd_avx_epi32(bsum, ones, vb);
+#else
+            acc = _mm256_dpbusd_epi32(acc, va, vb);
+            bsum = _mm256_dpbusd_epi32(bsum, ones, vb);
+#endif
+        }
+        return hsum(acc) - 128 * hsum(bsum);
+#elif defined(__AVX2__)
+        // расширение до int16 и vpmaddwd - без насыщения, в отличие от vpmaddubsw
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t k = 0; k < n; k += 32) {
+            __m256i va = _mm256_loadu_si256((const __m256i*)(a + k));
+            __m256i vb = _mm256_loadu_si256((const __m256i*)(b + k));
+            __m256i alo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(va));
+            __m256i ahi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(va, 1));
+            __m256i blo = _mm256_cvtepi8_epi16(_mm256_castsi256_si128(vb));
+            __m256i bhi = _mm256_cvtepi8_epi16(_mm256_extracti128_si256(vb, 1));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(alo, blo));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(ahi, bhi));
+        }
+        return hsum(acc);
+#else
+        int32_t acc[4] = {};
+        for (size_t k = 0; k < n; k += 4)
+            for (size_t l = 0; l < 4; l++)
+                acc[l] += (int32_t)a[k + l] * (int32_t)b[k + l];
+        return acc[0] + acc[1] + acc[2] + acc[3];
+#endif
+    }
+};
+
+// Квантованная матрица n x n: x = scale * (q - zero_point), q - int8
+class TQuantizedMatrix
+{
+    size_t n;
+    float sc;
+    int32_t zp;
+    std::vector<int8_t> mem;  // по строкам
+
+    static int8_t clamp(long v) noexcept
+    {
+        return (int8_t)(v < -128 ? -128 : (v > 127 ? 127 : v));
+    }
+public:
+    TQuantizedMatrix(size_t size = 1, float scale = 1.0f, int32_t zero_point = 0)
+        : n(size), sc(scale), zp(zero_point)
+    {
+        if (size == 0)
+            throw std::out_of_range("Matrix size should be greater than zero");
+        if (scale <= 0.0f)
+            throw std::invalid_argument("Scale should be positive");
+        if (zero_point < -128 || zero_point > 127)
+            throw std::invalid_argument("Zero point should fit into int8");
+        mem.assign(n * n, (int8_t)zero_point);
+    }
+
+    size_t size() const noexcept { return n; }
+    float scale() const noexcept { return sc; }
+    int32_t zero_point() const noexcept { return zp; }
+    const int8_t* row(size_t i) const noexcept { return mem.data() + i * n; }
+
+    int8_t& operator()(size_t i, size_t j)
+    {
+        if (i >= n || j >= n)
+            throw std::out_of_range("Too large index");
+        return mem[i * n + j];
+    }
+    int8_t operator()(size_t i, size_t j) const
+    {
+        if (i >= n || j >= n)
+            throw std::out_of_range("Too large index");
+        return mem[i * n + j];
+    }
+
+    // Асимметричное квантование по диапазону [min, max] матрицы
+    // (диапазон всегда включает 0, чтобы ноль представлялся точно);
+    // symmetric - zero_point = 0, диапазон [-max|x|, max|x|]
+    static TQuantizedMatrix quantize(const TDynamicMatrix<float>& m, bool symmetric = false)
+    {
+        size_t n = m.size();
+        float lo = 0.0f, hi = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            const float* p = m[i].data();
+            for (size_t j = 0; j < n; j++) {
+                lo = p[j] < lo ? p[j] : lo;
+                hi = p[j] > hi ? p[j] : hi;
+            }
+        }
+        float scale;
+        int32_t zero;
+        if (symmetric) {
+            float a = std::max(-lo, hi);
+            scale = a > 0.0f ? a / 127.0f : 1.0f;
+            zero = 0;
+        }
+        else {
+            scale = hi > lo ? (hi - lo) / 255.0f : 1.0f;
+            zero = (int32_t)std::lround(-128.0f - lo / scale);
+            zero = zero < -128 ? -128 : (zero > 127 ? 127 : zero);
+        }
+        TQuantizedMatrix q(n, scale, zero);
+        const float inv = 1.0f / scale;
+        for (size_t i = 0; i < n; i++) {
+            const float* p = m[i].data();
+            int8_t* r = q.mem.data() + i * n;
+            for (size_t j = 0; j < n; j++)
+                r[j] = clamp(std::lround(p[j] * inv) + zero);
+        }
+        return q;
+    }
+
+    TDynamicMatrix<float> dequantize() const
+    {
+        TDynamicMatrix<float> m(n);
+        for (size_t i = 0; i < n; i++) {
+            float* p = m[i].data();
+            const int8_t* r = row(i);
+            for (size_t j = 0; j < n; j++)
+                p[j] = sc * (float)((int32_t)r[j] - zp);
+        }
+        return m;
+    }
+
+    // Произведение в int32: sum_k (a_ik - za)(b_kj - zb).
+    // Строки A и столбцы B упаковываются в непрерывные массивы с длиной,
+    // кратной 32; поправки на нулевые точки считаются через суммы строк и столбцов
+    static TDynamicMatrix<int32_t> multiply_s32(const TQuantizedMatrix& a, const TQuantizedMatrix& b)
+    {
+        if (a.n != b.n)
+            throw std::invalid_argument("Matrix sizes are incompatible for multiplication");
+        const size_t n = a.n;
+        const size_t kp = (n + TInt8Dot::ALIGN - 1) / TInt8Dot::ALIGN * TInt8Dot::ALIGN;
+        std::vector<int8_t> pa(n * kp, 0), pbt(n * kp, 0);
+        std::vector<int32_t> rowsum(n, 0), colsum(n, 0);
+        for (size_t i = 0; i < n; i++)
+            for (size_t k = 0; k < n; k++) {
+                pa[i * kp + k] = a.mem[i * n + k];
+                rowsum[i] += a.mem[i * n + k];
+                pbt[i * kp + k] = b.mem[k * n + i];
+                colsum[i] += b.mem[k * n + i];
+            }
+        const int32_t za = a.zp, zb = b.zp;
+        const int32_t zz = (int32_t)n * za * zb;
+        TDynamicMatrix<int32_t> res(n);
+        const size_t bs = 64;
+        parallel_for(0, n, bs, [&](size_t r0, size_t r1) {
+            for (size_t jj = 0; jj < n; jj += bs) {
+                size_t je = std::min(jj + bs, n);
+                for (size_t i = r0; i < r1; i++) {
+                    int32_t* pc = res[i].data();
+                    const int8_t* ra = &pa[i * kp];
+                    for (size_t j = jj; j < je; j++)
+                        pc[j] = TInt8Dot::dot(ra, &pbt[j * kp], kp)
+                            - zb * rowsum[i] - za * colsum[j] + zz;
+                }
+            }
+        });
+        return res;
+    }
+
+    // Произведение в вещественных числах
+    friend TDynamicMatrix<float> operator*(const TQuantizedMatrix& a, const TQuantizedMatrix& b)
+    {
+        TDynamicMatrix<int32_t> s = multiply_s32(a, b);
+        const float scale = a.sc * b.sc;
+        size_t n = a.n;
+        TDynamicMatrix<float> res(n);
+        for (size_t i = 0; i < n; i++) {
+            const int32_t* ps = s[i].data();
+            float* pr = res[i].data();
+            for (size_t j = 0; j < n; j++)
+                pr[j] = scale * (float)ps[j];
+        }
+        return res;
+    }
+};
+
+#endif
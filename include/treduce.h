@@ -0,0 +1,255 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Редукции и нормы векторов
+
+#ifndef __TReduce_H__
+#define __TReduce_H__
+
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "tmatrix.h"
+
+// Тип норм: для целых элементов - double
+template<typename T>
+struct TNormType
+{
+    typedef typename std::conditional<std::is_integral<T>::value, double, T>::type type;
+};
+
+// Результат совмещенной редукции
+template<typename T>
+struct TVectorStats
+{
+    typedef typename TNormType<T>::type N;
+    T sum;
+    N l1;         // сумма модулей
+    N l2;         // евклидова норма
+    N max_abs;    // наибольший модуль
+    T min;
+    T max;
+    size_t argmin;
+    size_t argmax;
+};
+
+// Редукции по вектору - циклы с ACC независимыми аккумуляторами,
+// чтобы сложения не ждали друг друга и векторизовались
+template<typename T>
+class TReduce
+{
+    typedef typename TNormType<T>::type N;
+    static constexpr size_t ACC = 8;
+
+    // модуль в типе нормы: знак меняется после преобразования,
+    // поэтому для наименьшего целого нет переполнения
+    static N abs_of(T x) { return x < T() ? N(0) - N(x) : N(x); }
+
+    // сумма квадратов x / scale
+    static N scaled_squares(const T* p, size_t n, N scale)
+    {
+        N inv = N(1) / scale;
+        N acc[ACC] = {};
+        size_t i = 0;
+        for (; i + ACC <= n; i += ACC)
+            for (size_t k = 0; k < ACC; k++) {
+                N x = N(p[i + k]) * inv;
+                acc[k] += x * x;
+            }
+        N s = N();
+        for (; i < n; i++) {
+            N x = N(p[i]) * inv;
+            s += x * x;
+        }
+        for (size_t k = 0; k < ACC; k++)
+            s += acc[k];
+        return s;
+    }
+
+    static N max_abs_of(const T* p, size_t n)
+    {
+        N acc[ACC] = {};
+        size_t i = 0;
+        for (; i + ACC <= n; i += ACC)
+            for (size_t k = 0; k < ACC; k++) {
+                N a = abs_of(p[i + k]);
+                acc[k] = a > acc[k] ? a : acc[k];
+            }
+        N m = N();
+        for (; i < n; i++)
+            m = abs_of(p[i]) > m ? abs_of(p[i]) : m;
+        for (size_t k = 0; k < ACC; k++)
+            m = acc[k] > m ? acc[k] : m;
+        return m;
+    }
+
+    // норма по сумме квадратов; при переполнении или потере значимости -
+    // повторный проход с масштабированием на наибольший модуль, как в BLAS nrm2
+    static N finish_l2(const T* p, size_t n, N ssq)
+    {
+        if (std::isfinite(ssq) && ssq >= std::numeric_limits<N>::min() / std::numeric_limits<N>::epsilon())
+            return std::sqrt(ssq);
+        N amax = max_abs_of(p, n);
+        if (amax == N())
+            return N();
+        return amax * std::sqrt(scaled_squares(p, n, amax));
+    }
+public:
+    static T sum(const TDynamicVector<T>& v)
+    {
+        const T* p = v.data();
+        size_t n = v.size();
+        T acc[ACC] = {};
+        size_t i = 0;
+        for (; i + ACC <= n; i += ACC)
+            for (size_t k = 0; k < ACC; k++)
+                acc[k] += p[i + k];
+        T s = T();
+        for (; i < n; i++)
+            s += p[i];
+        for (size_t k = 0; k < ACC; k++)
+            s += acc[k];
+        return s;
+    }
+
+    static N l1(const TDynamicVector<T>& v)
+    {
+        const T* p = v.data();
+        size_t n = v.size();
+        N acc[ACC] = {};
+        size_t i = 0;
+        for (; i + ACC <= n; i += ACC)
+            for (size_t k = 0; k < ACC; k++)
+                acc[k] += abs_of(p[i + k]);
+        N s = N();
+        for (; i < n; i++)
+            s += abs_of(p[i]);
+        for (size_t k = 0; k < ACC; k++)
+            s += acc[k];
+        return s;
+    }
+
+    static N max_abs(const TDynamicVector<T>& v)
+    {
+        return max_abs_of(v.data(), v.size());
+    }
+
+    // евклидова норма без переполнения
+    static N l2(const TDynamicVector<T>& v)
+    {
+        const T* p = v.data();
+        size_t n = v.size();
+        N acc[ACC] = {};
+        size_t i = 0;
+        for (; i + ACC <= n; i += ACC)
+            for (size_t k = 0; k < ACC; k++)
+                acc[k] += N(p[i + k]) * N(p[i + k]);
+        N s = N();
+        for (; i < n; i++)
+            s += N(p[i]) * N(p[i]);
+        for (size_t k = 0; k < ACC; k++)
+            s += acc[k];
+        return finish_l2(p, n, s);
+    }
+
+    // индексы первого наименьшего и первого наибольшего элементов
+    static size_t argmin(const TDynamicVector<T>& v)
+    {
+        const T* p = v.data();
+        size_t best = 0;
+        for (size_t i = 1; i < v.size(); i++)
+            if (p[i] < p[best])
+                best = i;
+        return best;
+    }
+    static size_t argmax(const TDynamicVector<T>& v)
+    {
+        const T* p = v.data();
+        size_t best = 0;
+        for (size_t i = 1; i < v.size(); i++)
+            if (p[best] < p[i])
+                best = i;
+        return best;
+    }
+    static T min(const TDynamicVector<T>& v) { return v.data()[argmin(v)]; }
+    static T max(const TDynamicVector<T>& v) { return v.data()[argmax(v)]; }
+
+    // Все статистики за один проход по памяти, с ACC дорожками, как у
+    // отдельных редукций: у каждой дорожки свои суммы и экстремумы с
+    // индексами. Хвост суммируется отдельно и складывается в том же порядке,
+    // поэтому суммы совпадают с sum, l1 и l2 до бита
+    static TVectorStats<T> stats(const TDynamicVector<T>& v)
+    {
+        const T* p = v.data();
+        size_t n = v.size();
+        T s[ACC] = {}, mn[ACC], mx[ACC];
+        N a1[ACC] = {}, ssq[ACC] = {}, am[ACC] = {};
+        size_t imn[ACC], imx[ACC];
+        for (size_t k = 0; k < ACC; k++) {
+            mn[k] = mx[k] = p[0];
+            imn[k] = imx[k] = 0;
+        }
+        size_t i = 0;
+        for (; i + ACC <= n; i += ACC)
+            for (size_t k = 0; k < ACC; k++) {
+                T x = p[i + k];
+                N a = abs_of(x);
+                s[k] += x;
+                a1[k] += a;
+                ssq[k] += N(x) * N(x);
+                am[k] = a > am[k] ? a : am[k];
+                if (x < mn[k]) {
+                    mn[k] = x;
+                    imn[k] = i + k;
+                }
+                if (mx[k] < x) {
+                    mx[k] = x;
+                    imx[k] = i + k;
+                }
+            }
+        T st = T();
+        N a1t = N(), ssqt = N();
+        for (; i < n; i++) {
+            T x = p[i];
+            N a = abs_of(x);
+            st += x;
+            a1t += a;
+            ssqt += N(x) * N(x);
+            am[0] = a > am[0] ? a : am[0];
+            if (x < mn[0]) {
+                mn[0] = x;
+                imn[0] = i;
+            }
+            if (mx[0] < x) {
+                mx[0] = x;
+                imx[0] = i;
+            }
+        }
+        // при равных значениях дорожек берется меньший индекс - первое вхождение
+        TVectorStats<T> r;
+        r.max_abs = N();
+        r.min = mn[0];
+        r.max = mx[0];
+        r.argmin = imn[0];
+        r.argmax = imx[0];
+        for (size_t k = 0; k < ACC; k++) {
+            st += s[k];
+            a1t += a1[k];
+            ssqt += ssq[k];
+            r.max_abs = am[k] > r.max_abs ? am[k] : r.max_abs;
+            if (mn[k] < r.min || (!(r.min < mn[k]) && imn[k] < r.argmin)) {
+                r.min = mn[k];
+                r.argmin = imn[k];
+            }
+            if (r.max < mx[k] || (!(mx[k] < r.max) && imx[k] < r.argmax)) {
+                r.max = mx[k];
+                r.argmax = imx[k];
+            }
+        }
+        r.sum = st;
+        r.l1 = a1t;
+        r.l2 = finish_l2(p, n, ssqt);
+        return r;
+    }
+};
+
+#endif
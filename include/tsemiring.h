@@ -0,0 +1,51 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Умножение матриц над полукольцами и замыкание повторным возведением в квадрат
+
+#ifndef __TSemiring_H__
+#define __TSemiring_H__
+
+#include <vector>
+#include "tmatrix.h"
+
+// Произведение A * B над полукольцом S (TMinPlus, TMaxPlus, TOrAnd, ...) -
+// то же блочное ядро TGemm, что и у обычного умножения
+template<typename S, typename T>
+TDynamicMatrix<T> semiring_product(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+    if (a.size() != b.size())
+        throw std::invalid_argument("Matrix sizes are incompatible for multiplication");
+    size_t n = a.size();
+    TDynamicMatrix<T> res(n);
+    std::vector<const T*> pa(n), pb(n);
+    std::vector<T*> pc(n);
+    for (size_t i = 0; i < n; i++) {
+        pa[i] = a[i].data();
+        pb[i] = b[i].data();
+        pc[i] = res[i].data();
+    }
+    TGemm<T>::template blocked<S>({ pa.data(), 0 }, { pb.data(), 0 }, { pc.data(), 0 }, n, TGemmConfig<T>::snapshot());
+    return res;
+}
+
+// Замыкание A* = I + A + A^2 + ... над полукольцом S:
+// (I + A) возводится в квадрат, пока не перестанет меняться (не более ceil(log2 n) раз).
+// Для (min, +) - кратчайшие пути между всеми парами вершин (без отрицательных циклов),
+// для (or, and) - транзитивно-рефлексивное замыкание отношения
+template<typename S, typename T>
+TDynamicMatrix<T> semiring_closure(const TDynamicMatrix<T>& a)
+{
+    size_t n = a.size();
+    TDynamicMatrix<T> r(a);
+    for (size_t i = 0; i < n; i++)
+        r[i][i] = S::add(r[i][i], S::one());
+    for (size_t len = 1; len < n; len *= 2) {
+        TDynamicMatrix<T> next = semiring_product<S>(r, r);
+        if (next == r)
+            break;
+        r = std::move(next);
+    }
+    return r;
+}
+
+#endif
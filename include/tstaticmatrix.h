@@ -0,0 +1,263 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Векторы и матрицы фиксированного размера на стеке
+
+#ifndef __TStaticMatrix_H__
+#define __TStaticMatrix_H__
+
+#include <initializer_list>
+#include <utility>
+#include "tmatrix.h"
+
+// Статический вектор -
+// размер задается параметром шаблона, циклы разворачиваются при компиляции
+template<typename T, size_t N>
+class TStaticVector
+{
+    static_assert(N > 0, "Vector size should be greater than zero");
+    typedef std::make_index_sequence<N> Indices;
+
+    T mem[N];
+
+    template<typename F, size_t... I>
+    static constexpr TStaticVector generate(F f, std::index_sequence<I...>)
+    {
+        TStaticVector res;
+        ((res.mem[I] = f(I)), ...);
+        return res;
+    }
+    template<size_t... I>
+    constexpr bool equal(const TStaticVector& v, std::index_sequence<I...>) const
+    {
+        return ((mem[I] == v.mem[I]) && ...);
+    }
+    template<size_t... I>
+    constexpr T dot(const TStaticVector& v, std::index_sequence<I...>) const
+    {
+        return (T() + ... + (mem[I] * v.mem[I]));
+    }
+public:
+    constexpr TStaticVector() : mem{} {}
+    constexpr TStaticVector(std::initializer_list<T> init) : mem{}
+    {
+        if (init.size() > N)
+            throw std::out_of_range("Too many initializers");
+        size_t i = 0;
+        for (const T& x : init)
+            mem[i++] = x;
+    }
+    explicit TStaticVector(const TDynamicVector<T>& v) : mem{}
+    {
+        if (v.size() != N)
+            throw std::invalid_argument("Vector sizes do not match");
+        std::copy(v.data(), v.data() + N, mem);
+    }
+
+    static constexpr size_t size() noexcept { return N; }
+    constexpr T* data() noexcept { return mem; }
+    constexpr const T* data() const noexcept { return mem; }
+
+    // индексация
+    constexpr T& operator[](size_t index)
+    {
+        if (index >= N)
+            throw std::out_of_range("Too large index");
+        return mem[index];
+    }
+    constexpr const T& operator[](size_t index) const
+    {
+        if (index >= N)
+            throw std::out_of_range("Too large index");
+        return mem[index];
+    }
+
+    // сравнение
+    constexpr bool operator==(const TStaticVector& v) const
+    {
+        return equal(v, Indices());
+    }
+    constexpr bool operator!=(const TStaticVector& v) const
+    {
+        return !(*this == v);
+    }
+
+    // скалярные операции
+    constexpr TStaticVector operator+(T val) const
+    {
+        return generate([&](size_t i) { return mem[i] + val; }, Indices());
+    }
+    constexpr TStaticVector operator-(T val) const
+    {
+        return generate([&](size_t i) { return mem[i] - val; }, Indices());
+    }
+    constexpr TStaticVector operator*(T val) const
+    {
+        return generate([&](size_t i) { return mem[i] * val; }, Indices());
+    }
+
+    // векторные операции
+    constexpr TStaticVector operator+(const TStaticVector& v) const
+    {
+        return generate([&](size_t i) { return mem[i] + v.mem[i]; }, Indices());
+    }
+    constexpr TStaticVector operator-(const TStaticVector& v) const
+    {
+        return generate([&](size_t i) { return mem[i] - v.mem[i]; }, Indices());
+    }
+    constexpr T operator*(const TStaticVector& v) const
+    {
+        return dot(v, Indices());
+    }
+
+    // переход к динамическому вектору
+    TDynamicVector<T> to_dynamic() const
+    {
+        return TDynamicVector<T>(mem, N);
+    }
+    operator TDynamicVector<T>() const { return to_dynamic(); }
+
+    // ввод/вывод
+    friend istream& operator>>(istream& istr, TStaticVector& v)
+    {
+        for (size_t i = 0; i < N; i++)
+            istr >> v.mem[i];
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, const TStaticVector& v)
+    {
+        for (size_t i = 0; i < N; i++)
+            ostr << v.mem[i] << ' ';
+        return ostr;
+    }
+};
+
+// Статическая матрица N x N из статических строк
+template<typename T, size_t N>
+class TStaticMatrix
+{
+    typedef std::make_index_sequence<N> Indices;
+    typedef TStaticVector<T, N> Row;
+
+    Row rows[N];
+
+    template<typename F, size_t... I>
+    static constexpr TStaticMatrix generate(F f, std::index_sequence<I...>)
+    {
+        TStaticMatrix res;
+        ((res.rows[I] = f(I)), ...);
+        return res;
+    }
+    template<size_t... I>
+    constexpr bool equal(const TStaticMatrix& m, std::index_sequence<I...>) const
+    {
+        return ((rows[I] == m.rows[I]) && ...);
+    }
+    // элемент (i, j) произведения - свертка по k
+    template<size_t... K>
+    static constexpr T product_at(const TStaticMatrix& a, const TStaticMatrix& b, size_t i, size_t j,
+        std::index_sequence<K...>)
+    {
+        return (T() + ... + (a.rows[i].data()[K] * b.rows[K].data()[j]));
+    }
+public:
+    constexpr TStaticMatrix() : rows{} {}
+    constexpr TStaticMatrix(std::initializer_list<std::initializer_list<T>> init) : rows{}
+    {
+        if (init.size() > N)
+            throw std::out_of_range("Too many initializers");
+        size_t i = 0;
+        for (const auto& r : init)
+            rows[i++] = Row(r);
+    }
+    explicit TStaticMatrix(const TDynamicMatrix<T>& m) : rows{}
+    {
+        if (m.size() != N)
+            throw std::invalid_argument("Matrix sizes do not match");
+        for (size_t i = 0; i < N; i++)
+            rows[i] = Row(m[i]);
+    }
+
+    static constexpr size_t size() noexcept { return N; }
+
+    constexpr Row& operator[](size_t index)
+    {
+        if (index >= N)
+            throw std::out_of_range("Too large index");
+        return rows[index];
+    }
+    constexpr const Row& operator[](size_t index) const
+    {
+        if (index >= N)
+            throw std::out_of_range("Too large index");
+        return rows[index];
+    }
+
+    // сравнение
+    constexpr bool operator==(const TStaticMatrix& m) const
+    {
+        return equal(m, Indices());
+    }
+    constexpr bool operator!=(const TStaticMatrix& m) const
+    {
+        return !(*this == m);
+    }
+
+    // матрично-скалярные операции
+    constexpr TStaticMatrix operator*(const T& val) const
+    {
+        return generate([&](size_t i) { return rows[i] * val; }, Indices());
+    }
+
+    // матрично-векторные операции
+    constexpr TStaticVector<T, N> operator*(const TStaticVector<T, N>& v) const
+    {
+        TStaticVector<T, N> res;
+        for (size_t i = 0; i < N; i++)
+            res.data()[i] = rows[i] * v;
+        return res;
+    }
+
+    // матрично-матричные операции
+    constexpr TStaticMatrix operator+(const TStaticMatrix& m) const
+    {
+        return generate([&](size_t i) { return rows[i] + m.rows[i]; }, Indices());
+    }
+    constexpr TStaticMatrix operator-(const TStaticMatrix& m) const
+    {
+        return generate([&](size_t i) { return rows[i] - m.rows[i]; }, Indices());
+    }
+    constexpr TStaticMatrix operator*(const TStaticMatrix& m) const
+    {
+        TStaticMatrix res;
+        for (size_t i = 0; i < N; i++)
+            for (size_t j = 0; j < N; j++)
+                res.rows[i].data()[j] = product_at(*this, m, i, j, Indices());
+        return res;
+    }
+
+    // переход к динамической матрице
+    TDynamicMatrix<T> to_dynamic() const
+    {
+        TDynamicMatrix<T> m(N);
+        for (size_t i = 0; i < N; i++)
+            std::copy(rows[i].data(), rows[i].data() + N, m[i].data());
+        return m;
+    }
+    operator TDynamicMatrix<T>() const { return to_dynamic(); }
+
+    // ввод/вывод
+    friend istream& operator>>(istream& istr, TStaticMatrix& m)
+    {
+        for (size_t i = 0; i < N; i++)
+            istr >> m.rows[i];
+        return istr;
+    }
+    friend ostream& operator<<(ostream& ostr, const TStaticMatrix& m)
+    {
+        for (size_t i = 0; i < N; i++)
+            ostr << m.rows[i] << "\n";
+        return ostr;
+    }
+};
+
+#endif
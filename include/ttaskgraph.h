@@ -0,0 +1,324 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Граф задач с зависимостями по данным и исполнитель с перехватом работы
+
+#ifndef __TTaskGraph_H__
+#define __TTaskGraph_H__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "ttrace.h"
+
+class TTaskExecutor;
+
+// Граф задач над плитками. Задача объявляет ключи плиток, которые читает и
+// пишет; зависимости строятся в порядке добавления, как при последовательном
+// выполнении: чтение ждет последнюю запись (RAW), запись - последнюю запись
+// (WAW) и все чтения после нее (WAR). Поэтому граф выполняется с тем же
+// результатом, что и задачи по очереди, но каждая задача стартует сразу,
+// как только готовы ее плитки, без барьеров между фазами алгоритма
+class TTaskGraph
+{
+    friend class TTaskExecutor;
+
+    static constexpr size_t NONE = size_t(-1);
+
+    struct TNode
+    {
+        std::function<void()> f;
+        std::vector<size_t> next;
+        size_t deps = 0;
+        std::atomic<size_t> left{ 0 };  // невыполненных предшественников во время run
+    };
+    struct TAccess
+    {
+        size_t writer = NONE;
+        std::vector<size_t> readers;    // после последней записи
+    };
+
+    std::vector<std::unique_ptr<TNode>> nodes;
+    std::unordered_map<uint64_t, TAccess> access;
+
+    void edge(size_t from, size_t to)
+    {
+        // ребра к новой задаче добавляются подряд, поэтому повтор - последний элемент
+        std::vector<size_t>& nx = nodes[from]->next;
+        if (nx.empty() || nx.back() != to) {
+            nx.push_back(to);
+            nodes[to]->deps++;
+        }
+    }
+public:
+    TTaskGraph() = default;
+    TTaskGraph(const TTaskGraph&) = delete;
+    TTaskGraph& operator=(const TTaskGraph&) = delete;
+
+    // ключ плитки (i, j) матрицы с номером m; номер различает операнды одной задачи
+    static uint64_t tile(size_t m, size_t i, size_t j) noexcept
+    {
+        return ((uint64_t)m << 56) ^ ((uint64_t)i << 28) ^ (uint64_t)j;
+    }
+
+    size_t add(std::function<void()> f, const std::vector<uint64_t>& reads, const std::vector<uint64_t>& writes)
+    {
+        size_t id = nodes.size();
+        nodes.emplace_back(new TNode);
+        nodes[id]->f = std::move(f);
+        for (uint64_t k : reads) {
+            TAccess& a = access[k];
+            if (a.writer != NONE)
+                edge(a.writer, id);
+        }
+        for (uint64_t k : writes) {
+            TAccess& a = access[k];
+            if (a.writer != NONE)
+                edge(a.writer, id);
+            for (size_t r : a.readers)
+                if (r != id)
+                    edge(r, id);
+        }
+        for (uint64_t k : reads)
+            access[k].readers.push_back(id);
+        for (uint64_t k : writes) {
+            TAccess& a = access[k];
+            a.writer = id;
+            a.readers.clear();
+        }
+        return id;
+    }
+    size_t add(std::function<void()> f, std::initializer_list<uint64_t> reads, std::initializer_list<uint64_t> writes)
+    {
+        return add(std::move(f), std::vector<uint64_t>(reads), std::vector<uint64_t>(writes));
+    }
+
+    size_t size() const noexcept { return nodes.size(); }
+    size_t dependencies(size_t id) const { return nodes.at(id)->deps; }
+
+    void clear()
+    {
+        nodes.clear();
+        access.clear();
+    }
+
+    // выполнение всех задач; после первого исключения остальные задачи
+    // не запускаются, исключение пробрасывается, граф можно выполнить снова
+    inline void run(TTaskExecutor& ex);
+    inline void run();
+};
+
+// Исполнитель графов: у каждого потока своя очередь. Поток берет задачи с
+// конца своей очереди (последние готовые - их плитки еще в кэше), а когда она
+// пуста - крадет из начала чужих. Готовые последователи выполненной задачи
+// кладутся в очередь того же потока. Вызывающий run поток работает наравне
+// с остальными. Потоки свои, а не TThreadPool: задачи пула, ожидая, выполняют
+// чужие задачи пула, и цикл исполнителя внутри такой задачи не давал бы ей
+// завершиться. Графы выполняются по одному
+class TTaskExecutor
+{
+    struct TQueue
+    {
+        std::mutex mtx;
+        std::deque<size_t> q;
+    };
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<TQueue>> queues;   // 0 - вызывающий поток
+    std::mutex run_mtx;         // один граф за раз
+    std::mutex mtx;
+    std::condition_variable cv;
+    TTaskGraph* graph = nullptr;
+    size_t epoch = 0;           // номер запуска, по нему потоки просыпаются
+    bool stop = false;
+    std::atomic<size_t> remaining{ 0 };
+    std::atomic<size_t> busy{ 0 };      // потоков внутри текущего запуска
+    std::atomic<bool> failed{ false };
+    std::exception_ptr error;
+    std::atomic<size_t> stolen{ 0 };
+
+    static bool& inside()
+    {
+        thread_local bool in = false;
+        return in;
+    }
+
+    bool pop(size_t w, size_t& id)
+    {
+        TQueue& own = *queues[w];
+        {
+            std::lock_guard<std::mutex> lk(own.mtx);
+            if (!own.q.empty()) {
+                id = own.q.back();
+                own.q.pop_back();
+                return true;
+            }
+        }
+        for (size_t k = 1; k < queues.size(); k++) {
+            TQueue& victim = *queues[(w + k) % queues.size()];
+            std::lock_guard<std::mutex> lk(victim.mtx);
+            if (!victim.q.empty()) {
+                id = victim.q.front();
+                victim.q.pop_front();
+                stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+    void execute(TTaskGraph& g, size_t w, size_t id)
+    {
+        TTaskGraph::TNode& node = *g.nodes[id];
+        if (!failed.load(std::memory_order_acquire)) {
+            try {
+                TMATRIX_TRACE_SCOPE("graph_task");
+                node.f();
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> lk(mtx);
+                if (!error)
+                    error = std::current_exception();
+                failed.store(true, std::memory_order_release);
+            }
+        }
+        // после ошибки задачи не выполняются, но зависимости снимаются до конца
+        for (size_t s : node.next)
+            if (g.nodes[s]->left.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lk(queues[w]->mtx);
+                queues[w]->q.push_back(s);
+            }
+        remaining.fetch_sub(1);
+    }
+    // выполнение задач графа g, пока они не кончатся
+    void work(TTaskGraph& g, size_t w)
+    {
+        size_t id, idle = 0;
+        while (remaining.load() != 0) {
+            if (pop(w, id)) {
+                execute(g, w, id);
+                idle = 0;
+            }
+            else if (++idle < 64)
+                std::this_thread::yield();
+            else
+                std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    // Поток берет граф под mtx и входит в запуск (busy) до проверки remaining.
+    // run ждет busy == 0 только после того, как remaining стал 0, поэтому поток,
+    // проснувшийся поздно, либо учтен в busy, либо видит remaining == 0 и не
+    // возьмет задачи следующего запуска. Операции с busy и remaining -
+    // последовательно согласованные, на этом держится рассуждение
+    void loop(size_t w)
+    {
+        inside() = true;
+        size_t seen = 0;
+        for (;;) {
+            TTaskGraph* g;
+            {
+                std::unique_lock<std::mutex> lk(mtx);
+                cv.wait(lk, [&]() { return stop || epoch != seen; });
+                if (stop)
+                    return;
+                seen = epoch;
+                g = graph;
+                if (!g)
+                    continue;   // запуск уже закончился
+                busy.fetch_add(1);
+            }
+            work(*g, w);
+            busy.fetch_sub(1);
+        }
+    }
+public:
+    explicit TTaskExecutor(size_t threads)
+    {
+        for (size_t i = 0; i <= threads; i++)
+            queues.emplace_back(new TQueue);
+        for (size_t i = 1; i <= threads; i++)
+            workers.emplace_back([this, i]() { loop(i); });
+    }
+    TTaskExecutor(const TTaskExecutor&) = delete;
+    TTaskExecutor& operator=(const TTaskExecutor&) = delete;
+    ~TTaskExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            stop = true;
+        }
+        cv.notify_all();
+        for (auto& w : workers)
+            w.join();
+    }
+
+    // вызывающий поток - один из исполнителей, поэтому фоновых на один меньше ядер
+    static TTaskExecutor& instance()
+    {
+        static TTaskExecutor ex(std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+        return ex;
+    }
+
+    size_t threads() const noexcept { return workers.size(); }
+    // задач, взятых из чужих очередей, за все время
+    size_t steals() const noexcept { return stolen.load(std::memory_order_relaxed); }
+
+    void run(TTaskGraph& g)
+    {
+        if (inside())
+            throw std::logic_error("Task graph cannot be run from its own task");
+        std::lock_guard<std::mutex> run_lk(run_mtx);
+        if (g.nodes.empty())
+            return;
+        TMATRIX_TRACE_SCOPE("graph_run");
+        {
+            // очереди, граф и состояние запуска публикуются вместе с epoch
+            std::lock_guard<std::mutex> lk(mtx);
+            for (auto& n : g.nodes)
+                n->left.store(n->deps, std::memory_order_relaxed);
+            // готовые задачи раскладываются по очередям поровну
+            size_t r = 0;
+            for (size_t i = 0; i < g.nodes.size(); i++)
+                if (g.nodes[i]->deps == 0) {
+                    TQueue& q = *queues[r++ % queues.size()];
+                    std::lock_guard<std::mutex> qlk(q.mtx);
+                    q.q.push_back(i);
+                }
+            failed.store(false, std::memory_order_relaxed);
+            error = nullptr;
+            graph = &g;
+            remaining.store(g.nodes.size());
+            epoch++;
+        }
+        cv.notify_all();
+        inside() = true;
+        work(g, 0);
+        inside() = false;
+        // граф можно менять только после того, как все потоки вышли из work
+        while (busy.load() != 0)
+            std::this_thread::yield();
+        std::exception_ptr e;
+        {
+            std::lock_guard<std::mutex> lk(mtx);
+            graph = nullptr;
+            e = error;
+            error = nullptr;
+        }
+        if (e)
+            std::rethrow_exception(e);
+    }
+};
+
+inline void TTaskGraph::run(TTaskExecutor& ex) { ex.run(*this); }
+inline void TTaskGraph::run() { TTaskExecutor::instance().run(*this); }
+
+#endif
@@ -0,0 +1,226 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Плиточные разложения Холецкого и LU и умножение на графе задач
+
+#ifndef __TTiledAlgebra_H__
+#define __TTiledAlgebra_H__
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include "tmatrix.h"
+#include "ttaskgraph.h"
+
+// Алгоритмы разбивают матрицу на плитки tile x tile и строят граф задач над
+// плитками, а не циклы с барьерами. Панель шага k + 1 начинается, как только
+// обновлены ее плитки, пока остальное обновление шага k еще идет, поэтому
+// фазы панели и обновления перекрываются без явной логики опережения
+template<typename T>
+class TTiledAlgebra
+{
+    static_assert(std::is_floating_point<T>::value, "Tiled factorizations require a floating point type");
+
+    // плитка: строки матрицы со смещением по столбцам
+    struct TTile
+    {
+        TDynamicMatrix<T>* m;
+        size_t r, c, rows, cols;
+
+        T* row(size_t i) const { return (*m)[r + i].data() + c; }
+    };
+    struct TGrid
+    {
+        TDynamicMatrix<T>* m;
+        size_t t, cnt;
+
+        TGrid(TDynamicMatrix<T>& a, size_t tile) : m(&a), t(tile)
+        {
+            if (tile == 0)
+                throw std::invalid_argument("Tile size should be positive");
+            cnt = (a.size() + tile - 1) / tile;
+        }
+        size_t dim(size_t i) const { return std::min(t, m->size() - i * t); }
+        TTile operator()(size_t i, size_t j) const { return { m, i * t, j * t, dim(i), dim(j) }; }
+    };
+
+    static T dot(const T* a, const T* b, size_t n)
+    {
+        T s = T();
+        for (size_t l = 0; l < n; l++)
+            s += a[l] * b[l];
+        return s;
+    }
+
+    // A = L L^T для диагональной плитки, верхний треугольник обнуляется
+    static void potrf(const TTile& a)
+    {
+        for (size_t j = 0; j < a.rows; j++) {
+            T* rj = a.row(j);
+            T d = rj[j] - dot(rj, rj, j);
+            if (!(d > T()))
+                throw std::invalid_argument("Matrix is not positive definite");
+            rj[j] = std::sqrt(d);
+            for (size_t i = j + 1; i < a.rows; i++) {
+                T* ri = a.row(i);
+                ri[j] = (ri[j] - dot(ri, rj, j)) / rj[j];
+            }
+        }
+        for (size_t i = 0; i < a.rows; i++)
+            std::fill(a.row(i) + i + 1, a.row(i) + a.cols, T());
+    }
+    // B = B L^-T
+    static void trsm_lower_t(const TTile& l, const TTile& b)
+    {
+        for (size_t r = 0; r < b.rows; r++) {
+            T* x = b.row(r);
+            for (size_t c = 0; c < b.cols; c++)
+                x[c] = (x[c] - dot(x, l.row(c), c)) / l.row(c)[c];
+        }
+    }
+    // C -= A B^T; для диагональной плитки - только нижний треугольник
+    static void gemm_nt(const TTile& a, const TTile& b, const TTile& c, bool lower)
+    {
+        for (size_t r = 0; r < c.rows; r++) {
+            T* pc = c.row(r);
+            const T* pa = a.row(r);
+            size_t e = lower ? r + 1 : c.cols;
+            for (size_t j = 0; j < e; j++)
+                pc[j] -= dot(pa, b.row(j), a.cols);
+        }
+    }
+
+    // A = L U без выбора ведущего элемента, L с единичной диагональю
+    static void getrf(const TTile& a)
+    {
+        for (size_t k = 0; k < a.rows; k++) {
+            const T* rk = a.row(k);
+            if (rk[k] == T())
+                throw std::invalid_argument("Zero pivot in LU without pivoting");
+            for (size_t i = k + 1; i < a.rows; i++) {
+                T* ri = a.row(i);
+                ri[k] /= rk[k];
+                const T f = ri[k];
+                for (size_t j = k + 1; j < a.cols; j++)
+                    ri[j] -= f * rk[j];
+            }
+        }
+    }
+    // B = L^-1 B, L с единичной диагональю
+    static void trsm_lower_unit(const TTile& l, const TTile& b)
+    {
+        for (size_t r = 1; r < b.rows; r++) {
+            T* x = b.row(r);
+            const T* pl = l.row(r);
+            for (size_t k = 0; k < r; k++) {
+                const T f = pl[k];
+                const T* y = b.row(k);
+                for (size_t j = 0; j < b.cols; j++)
+                    x[j] -= f * y[j];
+            }
+        }
+    }
+    // B = B U^-1
+    static void trsm_upper(const TTile& u, const TTile& b)
+    {
+        for (size_t r = 0; r < b.rows; r++) {
+            T* x = b.row(r);
+            for (size_t c = 0; c < b.cols; c++) {
+                const T* pu = u.row(c);
+                x[c] /= pu[c];
+                const T f = x[c];
+                for (size_t j = c + 1; j < b.cols; j++)
+                    x[j] -= f * pu[j];
+            }
+        }
+    }
+    // C = C + s A B, s = 1 или -1
+    static void gemm_nn(const TTile& a, const TTile& b, const TTile& c, bool subtract)
+    {
+        for (size_t r = 0; r < c.rows; r++) {
+            T* pc = c.row(r);
+            const T* pa = a.row(r);
+            for (size_t k = 0; k < a.cols; k++) {
+                const T f = subtract ? -pa[k] : pa[k];
+                const T* pb = b.row(k);
+                for (size_t j = 0; j < c.cols; j++)
+                    pc[j] += f * pb[j];
+            }
+        }
+    }
+public:
+    // Разложение Холецкого на месте: в нижнем треугольнике остается L, A = L L^T,
+    // верхний треугольник обнуляется. Исключение, если матрица не положительно определена
+    static void cholesky(TDynamicMatrix<T>& a, size_t tile = 64, TTaskExecutor& ex = TTaskExecutor::instance())
+    {
+        TGrid g(a, tile);
+        TTaskGraph dag;
+        auto key = [](size_t i, size_t j) { return TTaskGraph::tile(0, i, j); };
+        for (size_t i = 0; i < g.cnt; i++)
+            for (size_t j = i + 1; j < g.cnt; j++)
+                dag.add([g, i, j]() {
+                    TTile z = g(i, j);
+                    for (size_t r = 0; r < z.rows; r++)
+                        std::fill(z.row(r), z.row(r) + z.cols, T());
+                }, {}, { key(i, j) });
+        for (size_t k = 0; k < g.cnt; k++) {
+            dag.add([g, k]() { potrf(g(k, k)); }, {}, { key(k, k) });
+            for (size_t i = k + 1; i < g.cnt; i++)
+                dag.add([g, i, k]() { trsm_lower_t(g(k, k), g(i, k)); }, { key(k, k) }, { key(i, k) });
+            for (size_t i = k + 1; i < g.cnt; i++)
+                for (size_t j = k + 1; j <= i; j++)
+                    dag.add([g, i, j, k]() { gemm_nt(g(i, k), g(j, k), g(i, j), i == j); },
+                        { key(i, k), key(j, k) }, { key(i, j) });
+        }
+        dag.run(ex);
+    }
+
+    // LU-разложение на месте без выбора ведущего элемента: строго под диагональю
+    // L (единицы на диагонали не хранятся), на диагонали и выше - U.
+    // Подходит для матриц с диагональным преобладанием и положительно определенных
+    static void lu(TDynamicMatrix<T>& a, size_t tile = 64, TTaskExecutor& ex = TTaskExecutor::instance())
+    {
+        TGrid g(a, tile);
+        TTaskGraph dag;
+        auto key = [](size_t i, size_t j) { return TTaskGraph::tile(0, i, j); };
+        for (size_t k = 0; k < g.cnt; k++) {
+            dag.add([g, k]() { getrf(g(k, k)); }, {}, { key(k, k) });
+            for (size_t j = k + 1; j < g.cnt; j++)
+                dag.add([g, k, j]() { trsm_lower_unit(g(k, k), g(k, j)); }, { key(k, k) }, { key(k, j) });
+            for (size_t i = k + 1; i < g.cnt; i++)
+                dag.add([g, i, k]() { trsm_upper(g(k, k), g(i, k)); }, { key(k, k) }, { key(i, k) });
+            for (size_t i = k + 1; i < g.cnt; i++)
+                for (size_t j = k + 1; j < g.cnt; j++)
+                    dag.add([g, i, j, k]() { gemm_nn(g(i, k), g(k, j), g(i, j), true); },
+                        { key(i, k), key(k, j) }, { key(i, j) });
+        }
+        dag.run(ex);
+    }
+
+    // C = A B: задачи по плиткам C, слагаемые по k одной плитки идут по очереди
+    static void multiply(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b, TDynamicMatrix<T>& c,
+        size_t tile = 64, TTaskExecutor& ex = TTaskExecutor::instance())
+    {
+        if (a.size() != b.size() || a.size() != c.size())
+            throw std::invalid_argument("Matrix sizes are incompatible for multiplication");
+        if (&c == &a || &c == &b)
+            throw std::invalid_argument("Result should not alias an operand");
+        // плитки A и B только читаются
+        TGrid ga(const_cast<TDynamicMatrix<T>&>(a), tile), gb(const_cast<TDynamicMatrix<T>&>(b), tile), gc(c, tile);
+        TTaskGraph dag;
+        for (size_t i = 0; i < gc.cnt; i++)
+            for (size_t j = 0; j < gc.cnt; j++) {
+                dag.add([gc, i, j]() {
+                    TTile z = gc(i, j);
+                    for (size_t r = 0; r < z.rows; r++)
+                        std::fill(z.row(r), z.row(r) + z.cols, T());
+                }, {}, { TTaskGraph::tile(2, i, j) });
+                for (size_t k = 0; k < gc.cnt; k++)
+                    dag.add([ga, gb, gc, i, j, k]() { gemm_nn(ga(i, k), gb(k, j), gc(i, j), false); },
+                        { TTaskGraph::tile(0, i, k), TTaskGraph::tile(1, k, j) }, { TTaskGraph::tile(2, i, j) });
+            }
+        dag.run(ex);
+    }
+};
+
+#endif
@@ -0,0 +1,238 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Трассировка ядер и планировщика в формате Chrome trace / Perfetto
+
+#ifndef __TTrace_H__
+#define __TTrace_H__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Завершенный интервал: имя (строковый литерал), поток, начало и длительность в нс
+struct TTraceEvent
+{
+    const char* name;
+    uint32_t tid;
+    uint64_t start;
+    uint64_t duration;
+};
+
+// Интервалы пишутся в кольцевой буфер своего потока без блокировок:
+// запись - несколько relaxed-сохранений и release-сдвиг головы, при переполнении
+// затираются старые интервалы. Чтение (events, dump_json) можно вызывать
+// в любой момент - интервалы, перезаписанные во время чтения, отбрасываются.
+// Буферы завершившихся потоков сохраняются и переходят к новым потокам
+class TTrace
+{
+public:
+    static constexpr size_t RING = 4096;    // слотов на поток, читаются RING - 1 последних интервалов
+private:
+    struct TRing
+    {
+        std::atomic<const char*> name[RING];
+        std::atomic<uint64_t> start[RING];
+        std::atomic<uint64_t> duration[RING];
+        std::atomic<uint32_t> tid[RING];
+        std::atomic<uint64_t> head;     // записано интервалов
+        std::atomic<uint64_t> claimed;  // начато записей: head или head + 1
+        uint32_t owner;
+
+        TRing() : head(0), claimed(0), owner(0) {}
+    };
+    struct TRegistry
+    {
+        std::mutex mtx;
+        std::vector<TRing*> all;
+        std::vector<TRing*> spare;      // буферы завершившихся потоков
+        uint32_t next_tid = 1;
+    };
+    // буфер потока: берется из запасных или создается, при выходе потока возвращается
+    struct THandle
+    {
+        TRing* ring;
+
+        THandle()
+        {
+            TRegistry& r = registry();
+            std::lock_guard<std::mutex> lk(r.mtx);
+            if (r.spare.empty()) {
+                ring = new TRing;
+                r.all.push_back(ring);
+            }
+            else {
+                ring = r.spare.back();
+                r.spare.pop_back();
+            }
+            ring->owner = r.next_tid++;
+        }
+        ~THandle()
+        {
+            TRegistry& r = registry();
+            std::lock_guard<std::mutex> lk(r.mtx);
+            r.spare.push_back(ring);
+        }
+    };
+
+    // не разрушается: потоки пула завершаются при выходе из программы и обращаются к нему
+    static TRegistry& registry()
+    {
+        static TRegistry* r = new TRegistry;
+        return *r;
+    }
+    static TRing& local()
+    {
+        thread_local THandle h;
+        return *h.ring;
+    }
+    static std::atomic<bool>& flag()
+    {
+        static std::atomic<bool> on(false);
+        return on;
+    }
+    static std::chrono::steady_clock::time_point epoch()
+    {
+        static const std::chrono::steady_clock::time_point t = std::chrono::steady_clock::now();
+        return t;
+    }
+public:
+    // сбор включается во время работы, по умолчанию выключен
+    static void enable(bool on = true) { flag().store(on, std::memory_order_relaxed); }
+    static bool enabled() noexcept { return flag().load(std::memory_order_relaxed); }
+
+    // наносекунды от первого обращения к трассировке
+    static uint64_t now() noexcept
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch()).count();
+    }
+
+    static void record(const char* name, uint64_t start, uint64_t end) noexcept
+    {
+        TRing& r = local();
+        uint64_t h = r.head.load(std::memory_order_relaxed);
+        size_t slot = (size_t)(h % RING);
+        // как в seqlock: запись объявляется до изменения слота - читатель,
+        // увидевший новые значения слота, увидит и claimed
+        r.claimed.store(h + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        r.name[slot].store(name, std::memory_order_relaxed);
+        r.start[slot].store(start, std::memory_order_relaxed);
+        r.duration[slot].store(end - start, std::memory_order_relaxed);
+        r.tid[slot].store(r.owner, std::memory_order_relaxed);
+        r.head.store(h + 1, std::memory_order_release);
+    }
+
+    // все сохраненные интервалы по возрастанию начала
+    static std::vector<TTraceEvent> events()
+    {
+        std::vector<TTraceEvent> res;
+        TRegistry& reg = registry();
+        std::lock_guard<std::mutex> lk(reg.mtx);
+        for (TRing* r : reg.all) {
+            uint64_t h = r->head.load(std::memory_order_acquire);
+            // слот самого старого интервала может переписываться прямо сейчас
+            uint64_t from = h >= RING ? h - RING + 1 : 0;
+            size_t first = res.size();
+            for (uint64_t i = from; i < h; i++) {
+                size_t slot = (size_t)(i % RING);
+                res.push_back({ r->name[slot].load(std::memory_order_relaxed), r->tid[slot].load(std::memory_order_relaxed),
+                    r->start[slot].load(std::memory_order_relaxed), r->duration[slot].load(std::memory_order_relaxed) });
+            }
+            // за время копирования поток мог начать затирать начало окна:
+            // слот i затронут, если начата запись с номером i + RING
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t c = r->claimed.load(std::memory_order_relaxed);
+            uint64_t lost = c > from + RING ? c - from - RING : 0;
+            lost = std::min<uint64_t>(lost, h - from);
+            res.erase(res.begin() + first, res.begin() + first + (size_t)lost);
+        }
+        std::sort(res.begin(), res.end(), [](const TTraceEvent& a, const TTraceEvent& b) { return a.start < b.start; });
+        return res;
+    }
+
+    // очистка буферов; вызывать, когда трассируемые операции не выполняются
+    static void clear()
+    {
+        TRegistry& reg = registry();
+        std::lock_guard<std::mutex> lk(reg.mtx);
+        for (TRing* r : reg.all) {
+            r->head.store(0, std::memory_order_release);
+            r->claimed.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // наносекунды как микросекунды с тремя знаками после точки
+    static void micros(std::ostream& os, uint64_t ns)
+    {
+        uint64_t f = ns % 1000;
+        os << ns / 1000 << '.' << char('0' + f / 100) << char('0' + f / 10 % 10) << char('0' + f % 10);
+    }
+
+    // JSON трассировки: завершенные события ("ph": "X"), время в микросекундах;
+    // открывается в chrome://tracing и ui.perfetto.dev
+    static void dump_json(std::ostream& os)
+    {
+        std::vector<TTraceEvent> ev = events();
+        os << "{\"traceEvents\": [";
+        for (size_t i = 0; i < ev.size(); i++) {
+            os << (i ? ",\n" : "\n") << "{\"name\": \"";
+            for (const char* p = ev[i].name; *p; p++) {
+                if (*p == '"' || *p == '\\')
+                    os << '\\';
+                os << *p;
+            }
+            os << "\", \"cat\": \"tmatrix\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << ev[i].tid
+               << ", \"ts\": ";
+            micros(os, ev[i].start);
+            os << ", \"dur\": ";
+            micros(os, ev[i].duration);
+            os << "}";
+        }
+        os << "\n], \"displayTimeUnit\": \"ns\"}\n";
+    }
+    static bool save(const std::string& path)
+    {
+        std::ofstream f(path);
+        if (!f)
+            return false;
+        dump_json(f);
+        return (bool)f;
+    }
+};
+
+// Интервал от создания до разрушения; если сбор выключен - только проверка флага
+class TTraceScope
+{
+    const char* name;
+    uint64_t t0;
+    bool on;
+public:
+    explicit TTraceScope(const char* n) noexcept : name(n), t0(0), on(TTrace::enabled())
+    {
+        if (on)
+            t0 = TTrace::now();
+    }
+    TTraceScope(const TTraceScope&) = delete;
+    TTraceScope& operator=(const TTraceScope&) = delete;
+    ~TTraceScope()
+    {
+        if (on)
+            TTrace::record(name, t0, TTrace::now());
+    }
+};
+
+// Без TMATRIX_ENABLE_TRACE разметка не компилируется
+#if defined(TMATRIX_ENABLE_TRACE)
+#define TMATRIX_TRACE_SCOPE(name) TTraceScope tmatrix_trace_scope_(name)
+#else
+#define TMATRIX_TRACE_SCOPE(name)
+#endif
+
+#endif
@@ -0,0 +1,168 @@
+// ННГУ, ИИТММ, Курс "Алгоритмы и структуры данных"
+//
+// Параметры умножения матриц и кэш настроек на диске
+
+#ifndef __TTuningCache_H__
+#define __TTuningCache_H__
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "ttrace.h"
+
+// Параметры умножения, настраиваются отдельно для каждого типа элементов
+struct TGemmParams
+{
+    size_t block_size = 64;           // сторона блока при блочном умножении
+    size_t parallel_threshold = 128;  // с этого размера строки блоков делятся между потоками
+    size_t strassen_threshold = 2048; // с этого размера используется Штрассен-Виноград
+    size_t strassen_cutoff = 256;     // размер, на котором рекурсия переходит к блочному умножению
+    bool precision_check = false;     // проверка точности результата Штрассена (только для вещественных)
+    double tolerance = 0.0;           // допустимая относительная ошибка, 0 - sqrt(eps)
+};
+
+template<typename T>
+struct TGemmConfig;
+
+// Имя типа элементов в файле настроек, одинаковое для всех компиляторов
+// (typeid(T).name() у них разный, и файл одной сборки не находился другой).
+// У арифметических типов строится по виду и размеру: float64, int32, uint8;
+// другие типы задают его специализацией, без нее их настройки на диске не хранятся
+template<typename T, typename = void>
+struct TTuningTag
+{
+    static std::string name() { return std::string(); }
+};
+template<typename T>
+struct TTuningTag<T, typename std::enable_if<std::is_arithmetic<T>::value>::type>
+{
+    static std::string name()
+    {
+        if (std::is_same<T, bool>::value)
+            return "bool";
+        const char* kind = std::is_floating_point<T>::value ? "float" : std::is_signed<T>::value ? "int" : "uint";
+        return kind + std::to_string(sizeof(T) * 8);
+    }
+};
+
+// Кэш настроек - текстовый файл, строка на пару (процессор, тип элементов):
+// модель<TAB>тип<TAB>block_size parallel_threshold strassen_threshold strassen_cutoff
+class TTuningCache
+{
+    std::map<std::pair<std::string, std::string>, TGemmParams> entries;
+public:
+    // модель процессора, по ней различаются хосты
+    static std::string cpu_model()
+    {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line))
+            if (line.compare(0, 10, "model name") == 0) {
+                size_t pos = line.find(':');
+                if (pos != std::string::npos) {
+                    pos = line.find_first_not_of(' ', pos + 1);
+                    return pos == std::string::npos ? std::string() : line.substr(pos);
+                }
+            }
+        return "unknown";
+    }
+
+    template<typename T>
+    static std::string type_key() { return TTuningTag<T>::name(); }
+
+    // путь из TMATRIX_TUNING_CACHE, иначе файл в текущем каталоге
+    static std::string default_path()
+    {
+        const char* env = std::getenv("TMATRIX_TUNING_CACHE");
+        return env && *env ? env : "tmatrix_tuning.cache";
+    }
+
+    bool load(const std::string& path)
+    {
+        TMATRIX_TRACE_SCOPE("tuning_load");
+        std::ifstream in(path);
+        if (!in)
+            return false;
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t t1 = line.find('\t');
+            size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+            if (t2 == std::string::npos)
+                continue;
+            TGemmParams p;
+            std::istringstream vals(line.substr(t2 + 1));
+            if (vals >> p.block_size >> p.parallel_threshold >> p.strassen_threshold >> p.strassen_cutoff)
+                entries[{ line.substr(0, t1), line.substr(t1 + 1, t2 - t1 - 1) }] = p;
+        }
+        return true;
+    }
+
+    bool save(const std::string& path) const
+    {
+        TMATRIX_TRACE_SCOPE("tuning_save");
+        std::ofstream out(path, std::ios::trunc);
+        if (!out)
+            return false;
+        for (const auto& e : entries)
+            out << e.first.first << '\t' << e.first.second << '\t'
+                << e.second.block_size << ' ' << e.second.parallel_threshold << ' '
+                << e.second.strassen_threshold << ' ' << e.second.strassen_cutoff << '\n';
+        return bool(out);
+    }
+
+    template<typename T>
+    void set(const TGemmParams& p)
+    {
+        if (type_key<T>().empty())
+            return;
+        entries[{ cpu_model(), type_key<T>() }] = p;
+    }
+
+    // сохраненные параметры для T на текущем процессоре переносятся в p
+    template<typename T>
+    bool find(TGemmParams& p) const
+    {
+        if (type_key<T>().empty())
+            return false;
+        auto it = entries.find({ cpu_model(), type_key<T>() });
+        if (it == entries.end())
+            return false;
+        p.block_size = it->second.block_size;
+        p.parallel_threshold = it->second.parallel_threshold;
+        p.strassen_threshold = it->second.strassen_threshold;
+        p.strassen_cutoff = it->second.strassen_cutoff;
+        return true;
+    }
+    // применить сохраненные параметры для T на текущем процессоре
+    template<typename T>
+    bool apply() const
+    {
+        TGemmParams p = TGemmConfig<T>::snapshot();
+        if (!find<T>(p))
+            return false;
+        TGemmConfig<T>::publish(p);
+        return true;
+    }
+
+    // Параметры по умолчанию с поправками из файла default_path(). Файл
+    // читается один раз, при первом обращении к параметрам любого типа, а не
+    // при статической инициализации, поэтому настройки применяются независимо
+    // от того, какие заголовки включены, а путь можно задать до первого умножения
+    template<typename T>
+    static TGemmParams stored()
+    {
+        static const TTuningCache startup = []() {
+            TTuningCache c;
+            c.load(default_path());
+            return c;
+        }();
+        TGemmParams p;
+        startup.find<T>(p);
+        return p;
+    }
+};
+#endif
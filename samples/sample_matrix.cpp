@@ -8,7 +8,7 @@
 #include "tmatrix.h"
 //---------------------------------------------------------------------------
 
-void main()
+int main()
 {
   TDynamicMatrix<int> a(5), b(5), c(5);
   int i, j;
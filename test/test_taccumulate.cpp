@@ -0,0 +1,66 @@
+#include "tmatrix.h"
+
+#include <gtest.h>
+
+namespace
+{
+// 1, 1e-8, 1e-8, ... - наивная сумма во float теряет все малые слагаемые
+TDynamicVector<float> ill_conditioned(size_t n)
+{
+    TDynamicVector<float> v(n);
+    v[0] = 1.0f;
+    for (size_t i = 1; i < n; i++)
+        v[i] = 1e-8f;
+    return v;
+}
+}
+
+TEST(TAccumulate, all_policies_agree_on_integers)
+{
+    int arr[] = { 1, 2, 3, 4, 5, 6, 7 };
+    for (TSumPolicy p : { TSumPolicy::naive, TSumPolicy::pairwise, TSumPolicy::kahan, TSumPolicy::wide })
+        EXPECT_EQ(140, TAccumulate<int>::dot(arr, arr, 7, p));
+}
+
+TEST(TAccumulate, compensated_policies_are_more_accurate_than_naive)
+{
+    const size_t n = 100001;
+    TDynamicVector<float> v = ill_conditioned(n), ones(n);
+    for (size_t i = 0; i < n; i++)
+        ones[i] = 1.0f;
+    const double exact = 1.0 + (n - 1) * 1e-8;
+    float naive = v.dot(ones, TSumPolicy::naive);
+    EXPECT_FLOAT_EQ(1.0f, naive);
+    EXPECT_NEAR(exact, v.dot(ones, TSumPolicy::kahan), 1e-6);
+    EXPECT_NEAR(exact, v.dot(ones, TSumPolicy::wide), 1e-6);
+}
+
+TEST(TAccumulate, default_policy_applies_to_operators)
+{
+    const size_t n = 20001;
+    TDynamicVector<float> v = ill_conditioned(n), ones(n);
+    for (size_t i = 0; i < n; i++)
+        ones[i] = 1.0f;
+    TSumConfig<float>::policy() = TSumPolicy::kahan;
+    float res = v * ones;
+    TSumConfig<float>::policy() = TSumPolicy::naive;
+    EXPECT_NEAR(1.0002, res, 1e-6);
+}
+
+TEST(TAccumulate, gemv_and_gemm_support_policies)
+{
+    const size_t n = 40;
+    TDynamicMatrix<double> a(n), b(n);
+    TDynamicVector<double> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = (double)i;
+        for (size_t j = 0; j < n; j++) {
+            a[i][j] = (double)((i + j) % 5);
+            b[i][j] = (double)((i * j) % 3);
+        }
+    }
+    for (TSumPolicy p : { TSumPolicy::pairwise, TSumPolicy::kahan, TSumPolicy::wide }) {
+        EXPECT_EQ(a * x, a.multiply(x, p));
+        EXPECT_EQ(a * b, a.multiply(b, p));
+    }
+}
@@ -0,0 +1,184 @@
+#include "tasync.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <gtest.h>
+
+namespace
+{
+    TDynamicMatrix<int> filled(size_t n, int base)
+    {
+        TDynamicMatrix<int> m(n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                m[i][j] = base + int(i * n + j) % 7;
+        return m;
+    }
+}
+
+TEST(TAsync, multiply_matches_sync)
+{
+    TDynamicMatrix<int> a = filled(20, 1), b = filled(20, -3);
+    TFuture<TDynamicMatrix<int>> f = async_multiply(a, b);
+    EXPECT_EQ(a * b, f.get());
+    EXPECT_TRUE(f.is_ready());
+}
+
+TEST(TAsync, add_and_sub_match_sync)
+{
+    TDynamicMatrix<int> a = filled(10, 2), b = filled(10, 5);
+    EXPECT_EQ(a + b, async_add(a, b).get());
+    EXPECT_EQ(a - b, async_sub(a, b).get());
+}
+
+TEST(TAsync, gemv_matches_sync)
+{
+    TDynamicMatrix<int> a = filled(8, 1);
+    TDynamicVector<int> v(8);
+    for (size_t i = 0; i < 8; i++)
+        v[i] = int(i);
+    EXPECT_EQ(a * v, async_multiply(a, v).get());
+}
+
+TEST(TAsync, then_chains_operations)
+{
+    TDynamicMatrix<int> a = filled(12, 1), b = filled(12, 2);
+    TFuture<int> f = async_multiply(a, b)
+        .then([&](const TDynamicMatrix<int>& m) { return m + a; })
+        .then([](const TDynamicMatrix<int>& m) { return m[3][4]; });
+    EXPECT_EQ((a * b + a)[3][4], f.get());
+}
+
+TEST(TAsync, futures_combine_into_pipeline)
+{
+    TDynamicMatrix<int> a = filled(10, 1), b = filled(10, 3), c = filled(10, -2);
+    TFuture<TDynamicMatrix<int>> ab = async_multiply(a, b);
+    TFuture<TDynamicMatrix<int>> bc = async_multiply(b, c);
+    TFuture<TDynamicMatrix<int>> r = async_add(ab, bc);
+    TFuture<TDynamicMatrix<int>> s = async_multiply(r, make_ready_future(a));
+    EXPECT_EQ((a * b + b * c) * a, s.get());
+}
+
+TEST(TAsync, result_is_shared_between_continuations)
+{
+    TFuture<int> f = async_run([]() { return 20; });
+    TFuture<int> x = f.then([](int v) { return v + 1; });
+    TFuture<int> y = f.then([](int v) { return v * 2; });
+    EXPECT_EQ(21, x.get());
+    EXPECT_EQ(40, y.get());
+    EXPECT_EQ(20, f.get());
+}
+
+TEST(TAsync, then_on_ready_future_runs)
+{
+    EXPECT_EQ(6, make_ready_future(5).then([](int v) { return v + 1; }).get());
+}
+
+TEST(TAsync, exception_propagates_through_chain)
+{
+    bool called = false;
+    TFuture<int> f = async_run([]() -> int { throw std::invalid_argument("bad"); })
+        .then([&](int v) { called = true; return v; });
+    EXPECT_THROW(f.get(), std::invalid_argument);
+    EXPECT_FALSE(called);
+}
+
+TEST(TAsync, size_mismatch_is_reported_by_get)
+{
+    TFuture<TDynamicMatrix<int>> f = async_add(TDynamicMatrix<int>(3), TDynamicMatrix<int>(4));
+    EXPECT_THROW(f.get(), std::invalid_argument);
+}
+
+TEST(TAsync, join_reports_first_error)
+{
+    TFuture<int> ok = make_ready_future(1);
+    TFuture<int> bad = async_run([]() -> int { throw std::out_of_range("x"); });
+    TFuture<int> r = async_join(ok, bad, [](int a, int b) { return a + b; });
+    EXPECT_THROW(r.get(), std::out_of_range);
+}
+
+TEST(TAsync, get_inside_pool_task_does_not_deadlock)
+{
+    TFuture<int> outer = async_run([]() {
+        int s = 0;
+        for (int i = 0; i < 8; i++)
+            s += async_run([i]() { return i; }).get();
+        return s;
+    });
+    EXPECT_EQ(28, outer.get());
+}
+
+TEST(TAsync, many_independent_operations)
+{
+    TDynamicMatrix<int> a = filled(6, 1);
+    std::vector<TFuture<TDynamicMatrix<int>>> fs;
+    for (int k = 0; k < 32; k++)
+        fs.push_back(async_multiply(a, filled(6, k)));
+    for (int k = 0; k < 32; k++)
+        EXPECT_EQ(a * filled(6, k), fs[k].get());
+}
+
+TEST(TAsync, load_reads_matrix_file)
+{
+    const char* path = "tasync_load_test.txt";
+    {
+        std::ofstream out(path);
+        out << "2\n1 2\n3 4\n";
+    }
+    TDynamicMatrix<int> m = async_load<int>(path).get();
+    std::remove(path);
+    ASSERT_EQ(2u, m.size());
+    EXPECT_EQ(1, m[0][0]);
+    EXPECT_EQ(4, m[1][1]);
+}
+
+TEST(TAsync, load_overlaps_with_compute)
+{
+    const char* path = "tasync_overlap_test.txt";
+    {
+        std::ofstream out(path);
+        out << "2\n1 0\n0 1\n";
+    }
+    TDynamicMatrix<int> a = filled(2, 3);
+    TFuture<TDynamicMatrix<int>> r = async_multiply(async_load<int>(path), async_multiply(a, a));
+    EXPECT_EQ(a * a, r.get());
+    std::remove(path);
+}
+
+TEST(TAsync, load_missing_file_throws)
+{
+    EXPECT_THROW(async_load<int>("no_such_matrix_file.txt").get(), std::runtime_error);
+}
+
+TEST(TAsync, load_truncated_file_throws)
+{
+    const char* path = "tasync_bad_test.txt";
+    {
+        std::ofstream out(path);
+        out << "3\n1 2 3\n";
+    }
+    TFuture<TDynamicMatrix<int>> f = async_load<int>(path);
+    EXPECT_THROW(f.get(), std::runtime_error);
+    std::remove(path);
+}
+
+TEST(TAsync, load_too_large_size_throws_runtime_error)
+{
+    const char* path = "tasync_large_test.txt";
+    {
+        std::ofstream out(path);
+        out << MAX_MATRIX_SIZE << "\n";
+    }
+    // размер отклоняется до создания матрицы, поэтому не out_of_range из ее конструктора
+    TFuture<TDynamicMatrix<int>> f = async_load<int>(path);
+    EXPECT_THROW(f.get(), std::runtime_error);
+    std::remove(path);
+}
+
+TEST(TAsync, default_future_is_invalid)
+{
+    TFuture<int> f;
+    EXPECT_FALSE(f.valid());
+    EXPECT_THROW(f.wait(), std::logic_error);
+}
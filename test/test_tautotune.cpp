@@ -0,0 +1,114 @@
+#include "tautotune.h"
+#include "tmatrix.h"
+
+#include <gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+
+TEST(TAutoTune, cpu_model_is_not_empty)
+{
+    EXPECT_FALSE(TTuningCache::cpu_model().empty());
+}
+
+TEST(TAutoTune, cache_round_trip_applies_params)
+{
+    const char* path = "test_tautotune_roundtrip.cache";
+    TGemmParams saved = TGemmConfig<double>::params();
+    TGemmParams p;
+    p.block_size = 24;
+    p.parallel_threshold = 300;
+    p.strassen_threshold = 1024;
+    p.strassen_cutoff = 96;
+    TTuningCache out;
+    out.set<double>(p);
+    ASSERT_TRUE(out.save(path));
+
+    TTuningCache in;
+    ASSERT_TRUE(in.load(path));
+    EXPECT_FALSE(in.apply<float>());
+    ASSERT_TRUE(in.apply<double>());
+    EXPECT_EQ(24, TGemmConfig<double>::params().block_size);
+    EXPECT_EQ(300, TGemmConfig<double>::params().parallel_threshold);
+    EXPECT_EQ(1024, TGemmConfig<double>::params().strassen_threshold);
+    EXPECT_EQ(96, TGemmConfig<double>::params().strassen_cutoff);
+    TGemmConfig<double>::params() = saved;
+    std::remove(path);
+}
+
+TEST(TAutoTune, tune_writes_cache_and_keeps_product_correct)
+{
+    const char* path = "test_tautotune_tune.cache";
+    TGemmParams saved = TGemmConfig<int>::params();
+    TTuneOptions o;
+    o.size = 64;
+    o.max_size = 128;
+    o.repeats = 1;
+    TGemmParams p = TAutoTuner<int>::tune(o, path);
+    EXPECT_EQ(p.block_size, TGemmConfig<int>::params().block_size);
+
+    TTuningCache in;
+    ASSERT_TRUE(in.load(path));
+    TGemmConfig<int>::params() = saved;
+    ASSERT_TRUE(in.apply<int>());
+    EXPECT_EQ(p.strassen_cutoff, TGemmConfig<int>::params().strassen_cutoff);
+
+    TDynamicMatrix<int> a(3), b(3);
+    for (size_t i = 0; i < 3; i++) {
+        a[i][i] = 2;
+        b[i][2 - i] = 1;
+    }
+    TDynamicMatrix<int> c = a * b;
+    EXPECT_EQ(2, c[0][2]);
+    EXPECT_EQ(0, c[0][0]);
+    TGemmConfig<int>::params() = saved;
+    std::remove(path);
+}
+
+TEST(TAutoTune, types_without_stored_entry_get_default_params)
+{
+    TGemmParams p = TTuningCache::stored<unsigned short>(), d;
+    EXPECT_EQ(d.block_size, p.block_size);
+    EXPECT_EQ(d.parallel_threshold, p.parallel_threshold);
+    EXPECT_EQ(d.strassen_threshold, p.strassen_threshold);
+    EXPECT_EQ(d.strassen_cutoff, p.strassen_cutoff);
+}
+
+TEST(TAutoTune, cache_keys_do_not_depend_on_compiler)
+{
+    EXPECT_EQ("float64", TTuningCache::type_key<double>());
+    EXPECT_EQ("float32", TTuningCache::type_key<float>());
+    EXPECT_EQ("int32", TTuningCache::type_key<int32_t>());
+    EXPECT_EQ("uint8", TTuningCache::type_key<uint8_t>());
+    // тип без имени не записывается в кэш
+    struct TNoTag {};
+    TTuningCache c;
+    c.set<TNoTag>(TGemmParams());
+    TGemmParams p;
+    EXPECT_FALSE(c.find<TNoTag>(p));
+}
+
+TEST(TAutoTune, tune_runs_alongside_multiplications)
+{
+    TGemmParams saved = TGemmConfig<int>::snapshot();
+    TDynamicMatrix<int> a(24), e(24);
+    for (size_t i = 0; i < 24; i++) {
+        a[i][(i + 1) % 24] = 1;
+        e[i][(i + 2) % 24] = 1;
+    }
+    std::atomic<bool> done(false), ok(true);
+    std::thread t([&]() {
+        while (!done.load())
+            if (a * a != e)
+                ok = false;
+    });
+    TTuneOptions o;
+    o.size = 32;
+    o.max_size = 64;
+    o.repeats = 1;
+    TAutoTuner<int>::tune(o, "");
+    done = true;
+    t.join();
+    EXPECT_TRUE(ok.load());
+    TGemmConfig<int>::publish(saved);
+}
@@ -0,0 +1,94 @@
+#include "tbatchmatrix.h"
+
+#include <gtest.h>
+
+namespace
+{
+TDynamicMatrix<double> sample_matrix(size_t n, size_t b)
+{
+    TDynamicMatrix<double> m(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            m[i][j] = (double)((i * 3 + j * 5 + b) % 7) - 3.0;
+    for (size_t i = 0; i < n; i++)
+        m[i][i] += 10.0 + b % 3;
+    return m;
+}
+}
+
+TEST(TBatchMatrix, cant_create_empty_batch)
+{
+    ASSERT_ANY_THROW(TBatchMatrix<double> m(0, 4));
+    ASSERT_ANY_THROW(TBatchMatrix<double> m(4, 0));
+}
+
+TEST(TBatchMatrix, can_set_and_get_matrix)
+{
+    TBatchMatrix<double> batch(10, 4);
+    TDynamicMatrix<double> m = sample_matrix(4, 7);
+    batch.set(7, m);
+    EXPECT_EQ(m, batch.get(7));
+    EXPECT_EQ(m[1][2], batch(7, 1, 2));
+    EXPECT_EQ(0.0, batch(6, 1, 2));
+}
+
+TEST(TBatchMatrix, throws_when_index_is_too_large)
+{
+    TBatchMatrix<double> batch(3, 4);
+    EXPECT_THROW(batch(3, 0, 0), std::out_of_range);
+    EXPECT_THROW(batch(0, 4, 0), std::out_of_range);
+}
+
+TEST(TBatchMatrix, batched_add_and_multiply_match_single_matrices)
+{
+    const size_t count = 37, n = 5;
+    TBatchMatrix<double> a(count, n), b(count, n);
+    for (size_t k = 0; k < count; k++) {
+        a.set(k, sample_matrix(n, k));
+        b.set(k, sample_matrix(n, k + 11));
+    }
+    TBatchMatrix<double> sum = a + b, prod = a * b;
+    for (size_t k = 0; k < count; k++) {
+        EXPECT_EQ(sample_matrix(n, k) + sample_matrix(n, k + 11), sum.get(k));
+        EXPECT_EQ(sample_matrix(n, k) * sample_matrix(n, k + 11), prod.get(k));
+    }
+}
+
+TEST(TBatchMatrix, batched_gemv_matches_single_matrices)
+{
+    const size_t count = 9, n = 6;
+    TBatchMatrix<double> a(count, n);
+    TBatchVector<double> x(count, n);
+    for (size_t k = 0; k < count; k++) {
+        a.set(k, sample_matrix(n, k));
+        for (size_t i = 0; i < n; i++)
+            x(k, i) = (double)(i + k);
+    }
+    TBatchVector<double> y = a * x;
+    for (size_t k = 0; k < count; k++)
+        EXPECT_EQ(sample_matrix(n, k) * x.get(k), y.get(k));
+}
+
+TEST(TBatchMatrix, batched_solve_recovers_solution)
+{
+    const size_t count = 13, n = 8;
+    TBatchMatrix<double> a(count, n);
+    TBatchVector<double> x(count, n);
+    for (size_t k = 0; k < count; k++) {
+        a.set(k, sample_matrix(n, k));
+        for (size_t i = 0; i < n; i++)
+            x(k, i) = (double)i - (double)k;
+    }
+    TBatchVector<double> sol = a.solve(a * x);
+    for (size_t k = 0; k < count; k++)
+        for (size_t i = 0; i < n; i++)
+            EXPECT_NEAR(x(k, i), sol(k, i), 1e-9);
+}
+
+TEST(TBatchMatrix, solve_throws_for_singular_matrix)
+{
+    TBatchMatrix<double> a(2, 3);
+    a.set(0, sample_matrix(3, 0));
+    TBatchVector<double> f(2, 3);
+    EXPECT_THROW(a.solve(f), std::invalid_argument);
+}
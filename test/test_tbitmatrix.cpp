@@ -0,0 +1,132 @@
+#include "tbitmatrix.h"
+#include "tsemiring.h"
+
+#include <gtest.h>
+
+namespace
+{
+TDynamicMatrix<int> random_graph(size_t n, unsigned seed, unsigned density)
+{
+    TDynamicMatrix<int> m(n);
+    unsigned x = seed;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            x = x * 1103515245u + 12345u;
+            m[i][j] = (x >> 16) % 100 < density ? 1 : 0;
+        }
+    return m;
+}
+}
+
+TEST(TBitMatrix, can_create_matrix_with_positive_size)
+{
+    ASSERT_NO_THROW(TBitMatrix m(70));
+}
+
+TEST(TBitMatrix, throws_when_create_matrix_with_zero_size)
+{
+    ASSERT_ANY_THROW(TBitMatrix m(0));
+}
+
+TEST(TBitMatrix, can_set_and_get_bits)
+{
+    TBitMatrix m(100);
+    m.set(3, 70);
+    m.set(99, 99);
+    EXPECT_TRUE(m(3, 70));
+    EXPECT_TRUE(m.get(99, 99));
+    EXPECT_FALSE(m(70, 3));
+    m.set(3, 70, false);
+    EXPECT_FALSE(m(3, 70));
+    EXPECT_EQ(2u, m.words());
+}
+
+TEST(TBitMatrix, throws_when_index_is_too_large)
+{
+    TBitMatrix m(5);
+    ASSERT_ANY_THROW(m.get(5, 0));
+    ASSERT_ANY_THROW(m.set(0, 5));
+}
+
+TEST(TBitMatrix, converts_to_and_from_dynamic_matrix)
+{
+    TDynamicMatrix<int> g = random_graph(67, 1, 30);
+    TBitMatrix b(g);
+    EXPECT_EQ(g, b.to_matrix<int>());
+}
+
+TEST(TBitMatrix, elementwise_operations_match_definition)
+{
+    const size_t n = 90;
+    TDynamicMatrix<int> a = random_graph(n, 2, 50), b = random_graph(n, 3, 50);
+    TBitMatrix ba(a), bb(b);
+    TBitMatrix band = ba & bb, bor = ba | bb, bxor = ba ^ bb;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            EXPECT_EQ(a[i][j] && b[i][j], band(i, j));
+            EXPECT_EQ(a[i][j] || b[i][j], bor(i, j));
+            EXPECT_EQ(a[i][j] != b[i][j], bxor(i, j));
+        }
+}
+
+TEST(TBitMatrix, count_and_intersect_use_popcount)
+{
+    const size_t n = 130;
+    TDynamicMatrix<int> a = random_graph(n, 4, 40);
+    TBitMatrix b(a);
+    size_t total = 0;
+    for (size_t i = 0; i < n; i++) {
+        size_t row = 0;
+        for (size_t j = 0; j < n; j++)
+            row += a[i][j];
+        EXPECT_EQ(row, b.count(i));
+        total += row;
+    }
+    EXPECT_EQ(total, b.count());
+    size_t common = 0;
+    for (size_t j = 0; j < n; j++)
+        common += a[5][j] & a[77][j];
+    EXPECT_EQ(common, b.intersect(5, b, 77));
+}
+
+TEST(TBitMatrix, transpose_swaps_indices)
+{
+    TDynamicMatrix<int> a = random_graph(70, 5, 20);
+    TBitMatrix t = TBitMatrix(a).transpose();
+    for (size_t i = 0; i < 70; i++)
+        for (size_t j = 0; j < 70; j++)
+            EXPECT_EQ(a[j][i] != 0, t(i, j));
+}
+
+TEST(TBitMatrix, product_matches_or_and_semiring)
+{
+    for (size_t n : { 1, 7, 64, 100, 300 }) {
+        TDynamicMatrix<int> a = random_graph(n, 6 + (unsigned)n, 5), b = random_graph(n, 7, 5);
+        TBitMatrix c = TBitMatrix(a) * TBitMatrix(b);
+        EXPECT_EQ(semiring_product<TOrAnd<int>>(a, b), c.to_matrix<int>());
+    }
+}
+
+TEST(TBitMatrix, product_with_identity_is_unchanged)
+{
+    TBitMatrix a(TDynamicMatrix<int>(random_graph(77, 8, 30)));
+    EXPECT_EQ(a, a * TBitMatrix::identity(77));
+    EXPECT_EQ(a, TBitMatrix::identity(77) * a);
+}
+
+TEST(TBitMatrix, throws_when_multiply_matrices_with_different_size)
+{
+    TBitMatrix a(3), b(4);
+    ASSERT_ANY_THROW(a * b);
+}
+
+TEST(TBitMatrix, closure_gives_transitive_reachability)
+{
+    for (size_t n : { 10, 270 }) {
+        TDynamicMatrix<int> g = random_graph(n, 9, n < 100 ? 10 : 1);
+        TBitMatrix c = TBitMatrix(g).closure();
+        // A+ = A * A*
+        TDynamicMatrix<int> expect = semiring_product<TOrAnd<int>>(g, semiring_closure<TOrAnd<int>>(g));
+        EXPECT_EQ(expect, c.to_matrix<int>());
+    }
+}
@@ -0,0 +1,104 @@
+#include "tcompare.h"
+
+#include <gtest.h>
+
+TEST(TAllClose, equal_vectors_are_close)
+{
+    TDynamicVector<double> a(10);
+    for (size_t i = 0; i < 10; i++)
+        a[i] = (double)i / 3.0;
+    EXPECT_TRUE(all_close(a, a));
+}
+
+TEST(TAllClose, respects_relative_and_absolute_tolerance)
+{
+    TDynamicVector<double> a(9), b(9);
+    for (size_t i = 0; i < 9; i++) {
+        a[i] = 1000.0 + i;
+        b[i] = 1000.0 + i;
+    }
+    a[7] += 0.5;
+    EXPECT_FALSE(all_close(a, b));
+    EXPECT_TRUE(all_close(a, b, 1e-3));
+    EXPECT_TRUE(all_close(a, b, 0.0, 0.5));
+    EXPECT_FALSE(all_close(a, b, 0.0, 0.4));
+}
+
+TEST(TAllClose, handles_nan_and_infinity)
+{
+    TDynamicVector<float> a(11), b(11);
+    for (size_t i = 0; i < 11; i++)
+        a[i] = b[i] = (float)i;
+    a[2] = b[2] = std::numeric_limits<float>::infinity();
+    EXPECT_TRUE(all_close(a, b));
+    a[9] = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_FALSE(all_close(a, b));
+    a[9] = b[9];
+    a[2] = -a[2];
+    EXPECT_FALSE(all_close(a, b));
+}
+
+TEST(TAllClose, violations_counts_every_bad_element)
+{
+    // два нарушения в одной группе векторной части и одно в хвосте
+    double a[19] = {}, b[19] = {};
+    float fa[19] = {}, fb[19] = {};
+    for (size_t k : { 0, 1, 18 }) {
+        a[k] = 1.0;
+        fa[k] = 1.0f;
+    }
+    EXPECT_EQ(3u, TAllClose<double>::violations(a, b, 19, 1e-5, 1e-8));
+    EXPECT_EQ(3u, TAllClose<float>::violations(fa, fb, 19, 1e-5f, 1e-8f));
+    EXPECT_EQ(0u, TAllClose<double>::violations(b, b, 19, 1e-5, 1e-8));
+}
+
+TEST(TAllClose, vectors_of_different_size_are_not_close)
+{
+    TDynamicVector<double> a(3), b(4);
+    EXPECT_FALSE(all_close(a, b));
+}
+
+TEST(TAllClose, works_for_integer_elements)
+{
+    TDynamicVector<int> a(5), b(5);
+    b[4] = 1;
+    EXPECT_FALSE(all_close(a, b));
+    EXPECT_TRUE(all_close(a, b, 0.0, 1.0));
+}
+
+TEST(TAllClose, compares_matrices)
+{
+    const size_t n = 40;
+    TDynamicMatrix<double> a(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            a[i][j] = b[i][j] = 1.0 / (double)(i + j + 1);
+    b[n - 1][n - 1] *= 1.0 + 1e-9;
+    EXPECT_TRUE(all_close(a, b));
+    b[n - 1][n - 2] *= 1.001;
+    EXPECT_FALSE(all_close(a, b));
+    EXPECT_FALSE(all_close(a, TDynamicMatrix<double>(n - 1)));
+}
+
+TEST(TAllClose, large_comparison_does_not_depend_on_mode)
+{
+    const size_t n = 300000;
+    TDynamicVector<double> a(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        a[i] = b[i] = (double)(i % 101);
+    b[n - 3] += 1.0;
+    for (TExecMode m : { TExecMode::sequential, TExecMode::parallel }) {
+        TParallelConfig::mode() = m;
+        EXPECT_FALSE(all_close(a, b));
+        EXPECT_TRUE(all_close(a, b, 0.0, 1.0));
+    }
+    TParallelConfig::mode() = TExecMode::automatic;
+}
+
+TEST(TAllClose, finite_value_is_not_close_to_infinity)
+{
+    TDynamicVector<double> a(2), b(2);
+    b[0] = std::numeric_limits<double>::infinity();
+    a[0] = 1e300;
+    EXPECT_FALSE(all_close(a, b, 0.5));
+}
@@ -0,0 +1,116 @@
+#include "tcowmatrix.h"
+
+#include <gtest.h>
+#include <thread>
+#include <vector>
+
+TEST(TCowMatrix, can_create_matrix_with_positive_length)
+{
+    ASSERT_NO_THROW(TCowMatrix<int> m(5));
+}
+
+TEST(TCowMatrix, copy_shares_buffer)
+{
+    TCowMatrix<int> m(3);
+    TCowMatrix<int> c(m);
+    EXPECT_TRUE(m.shared());
+    EXPECT_EQ(2, m.use_count());
+    EXPECT_EQ(&m.matrix(), &c.matrix());
+}
+
+TEST(TCowMatrix, read_access_does_not_detach)
+{
+    TCowMatrix<int> m(3);
+    const TCowMatrix<int> c(m);
+    EXPECT_EQ(0, c[1][1]);
+    EXPECT_TRUE(m.shared());
+}
+
+TEST(TCowMatrix, write_access_detaches_copy)
+{
+    TCowMatrix<int> m(3);
+    TCowMatrix<int> c(m);
+    c[0][0] = 100;
+    EXPECT_FALSE(m.shared());
+    EXPECT_FALSE(c.shared());
+    EXPECT_EQ(0, m[0][0]);
+    EXPECT_EQ(100, c[0][0]);
+}
+
+TEST(TCowMatrix, explicit_detach_makes_buffer_unique)
+{
+    TCowMatrix<int> m(3);
+    TCowMatrix<int> c = m;
+    c.detach();
+    EXPECT_EQ(1, m.use_count());
+    EXPECT_EQ(1, c.use_count());
+    EXPECT_EQ(m, c);
+}
+
+TEST(TCowMatrix, assignment_releases_old_buffer)
+{
+    TCowMatrix<int> m(3), a(4);
+    TCowMatrix<int> b = a;
+    b = m;
+    EXPECT_EQ(1, a.use_count());
+    EXPECT_EQ(2, m.use_count());
+    EXPECT_EQ(3, b.size());
+}
+
+TEST(TCowMatrix, can_add_and_multiply_shared_matrices)
+{
+    TDynamicMatrix<int> src(2);
+    src[0][0] = 1; src[0][1] = 2;
+    src[1][0] = 3; src[1][1] = 4;
+    TCowMatrix<int> a(src);
+    TCowMatrix<int> b = a;
+    TCowMatrix<int> sum = a + b;
+    TCowMatrix<int> prod = a * b;
+    EXPECT_EQ(8, sum[1][1]);
+    EXPECT_EQ(7, prod[0][0]);
+    EXPECT_EQ(22, prod[1][1]);
+    EXPECT_TRUE(a.shared());
+}
+
+TEST(TCowMatrix, refcount_is_thread_safe)
+{
+    TCowMatrix<int> m(3);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&m]() {
+            for (int i = 0; i < 1000; i++) {
+                TCowMatrix<int> c(m);
+                c[0][0] = i;
+            }
+        });
+    for (auto& th : threads)
+        th.join();
+    EXPECT_EQ(1, m.use_count());
+    EXPECT_EQ(0, m[0][0]);
+}
+
+TEST(TCowMatrix, copy_after_write_reference_does_not_share)
+{
+    TCowMatrix<int> m(3);
+    TDynamicVector<int>& row = m[0];
+    TCowMatrix<int> c(m);
+    EXPECT_FALSE(m.shared());
+    row[0] = 5;
+    EXPECT_EQ(5, m.matrix()[0][0]);
+    EXPECT_EQ(0, c.matrix()[0][0]);
+    TCowMatrix<int> d;
+    d = m;
+    EXPECT_FALSE(d.shared());
+}
+
+TEST(TCowMatrix, moved_from_matrix_is_empty)
+{
+    TCowMatrix<int> m(3);
+    TCowMatrix<int> c(std::move(m));
+    EXPECT_EQ(0, m.size());
+    EXPECT_THROW(m.matrix(), std::logic_error);
+    EXPECT_THROW(m[0], std::logic_error);
+    EXPECT_NE(m, c);
+    TCowMatrix<int> e(m);
+    EXPECT_EQ(0, e.size());
+}
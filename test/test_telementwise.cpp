@@ -0,0 +1,136 @@
+#include "telementwise.h"
+
+#include <gtest.h>
+
+namespace
+{
+TDynamicMatrix<int> sample(size_t n, int seed)
+{
+    TDynamicMatrix<int> m(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            m[i][j] = (int)((i * 7 + j * 3 + seed) % 11) - 5;
+    return m;
+}
+}
+
+TEST(TElementwise, map_applies_function_to_vector)
+{
+    TDynamicVector<int> v(5);
+    for (size_t i = 0; i < 5; i++)
+        v[i] = (int)i - 2;
+    TDynamicVector<double> r = TElementwise::map(v, [](int x) { return x * 0.5; });
+    for (size_t i = 0; i < 5; i++)
+        EXPECT_EQ(((int)i - 2) * 0.5, r[i]);
+}
+
+TEST(TElementwise, map_clamps_matrix)
+{
+    TDynamicMatrix<int> m = sample(9, 1);
+    TDynamicMatrix<int> r = TElementwise::map(m, [](int x) { return x < -1 ? -1 : (x > 1 ? 1 : x); });
+    for (size_t i = 0; i < 9; i++)
+        for (size_t j = 0; j < 9; j++)
+            EXPECT_EQ(std::max(-1, std::min(1, m[i][j])), r[i][j]);
+}
+
+TEST(TElementwise, zip_divides_vectors)
+{
+    TDynamicVector<double> a(4), b(4);
+    for (size_t i = 0; i < 4; i++) {
+        a[i] = (double)i;
+        b[i] = 2.0;
+    }
+    TDynamicVector<double> r = TElementwise::zip(a, b, [](double x, double y) { return x / y; });
+    for (size_t i = 0; i < 4; i++)
+        EXPECT_EQ(i / 2.0, r[i]);
+}
+
+TEST(TElementwise, zip_throws_when_sizes_differ)
+{
+    TDynamicVector<int> a(3), b(4);
+    TDynamicMatrix<int> c(3), d(4);
+    auto f = [](int x, int y) { return x + y; };
+    ASSERT_ANY_THROW(TElementwise::zip(a, b, f));
+    ASSERT_ANY_THROW(TElementwise::zip(c, d, f));
+}
+
+TEST(TElementwise, reduce_and_map_reduce)
+{
+    TDynamicMatrix<int> m = sample(20, 2);
+    int sum = 0, sq = 0;
+    for (size_t i = 0; i < 20; i++)
+        for (size_t j = 0; j < 20; j++) {
+            sum += m[i][j];
+            sq += m[i][j] * m[i][j];
+        }
+    EXPECT_EQ(sum, TElementwise::reduce(m, 0, [](int x, int y) { return x + y; }));
+    EXPECT_EQ(sq, TElementwise::map_reduce(m, 0, [](int x) { return x * x; }, [](int x, int y) { return x + y; }));
+    int row = 0;
+    for (size_t j = 0; j < 20; j++)
+        row += m[3][j];
+    EXPECT_EQ(row, TElementwise::reduce(m[3], 0, [](int x, int y) { return x + y; }));
+}
+
+TEST(TElementwise, large_operations_do_not_depend_on_mode)
+{
+    const size_t n = 300000;
+    TDynamicVector<double> a(n), b(n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = 1.0 / (double)(i + 1);
+        b[i] = (double)(i % 7) - 3.0;
+    }
+    auto sum = [](double x, double y) { return x + y; };
+    TParallelConfig::mode() = TExecMode::sequential;
+    TDynamicVector<double> h = hadamard(a, b);
+    double s = TElementwise::reduce(h, 0.0, sum);
+    TParallelConfig::mode() = TExecMode::parallel;
+    EXPECT_EQ(h, hadamard(a, b));
+    EXPECT_EQ(s, TElementwise::reduce(hadamard(a, b), 0.0, sum));
+    EXPECT_EQ(s, TElementwise::map_reduce(TElementwise::zip(a, b, [](double x, double y) { return x * y; }),
+        0.0, [](double x) { return x; }, sum));
+    TParallelConfig::mode() = TExecMode::automatic;
+}
+
+TEST(TElementwise, hadamard_of_matrices)
+{
+    TDynamicMatrix<int> a = sample(6, 3), b = sample(6, 4);
+    TDynamicMatrix<int> h = hadamard(a, b);
+    for (size_t i = 0; i < 6; i++)
+        for (size_t j = 0; j < 6; j++)
+            EXPECT_EQ(a[i][j] * b[i][j], h[i][j]);
+}
+
+TEST(TElementwise, kronecker_of_matrices)
+{
+    TDynamicMatrix<int> a = sample(3, 5), b = sample(4, 6);
+    TDynamicMatrix<int> k = kronecker(a, b);
+    ASSERT_EQ(12u, k.size());
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            for (size_t p = 0; p < 4; p++)
+                for (size_t q = 0; q < 4; q++)
+                    EXPECT_EQ(a[i][j] * b[p][q], k[i * 4 + p][j * 4 + q]);
+}
+
+TEST(TElementwise, kronecker_into_preallocated_matrix)
+{
+    TDynamicMatrix<int> a = sample(5, 7), b = sample(7, 8);
+    TDynamicMatrix<int> res(35), bad(34);
+    TParallelConfig::mode() = TExecMode::parallel;
+    kronecker(a, b, res);
+    TParallelConfig::mode() = TExecMode::automatic;
+    EXPECT_EQ(kronecker(a, b), res);
+    ASSERT_ANY_THROW(kronecker(a, b, bad));
+}
+
+TEST(TElementwise, kronecker_of_vectors)
+{
+    TDynamicVector<int> a(2), b(3);
+    a[0] = 1; a[1] = -2;
+    b[0] = 3; b[1] = 4; b[2] = 5;
+    TDynamicVector<int> k = kronecker(a, b);
+    int expect[] = { 3, 4, 5, -6, -8, -10 };
+    ASSERT_EQ(6u, k.size());
+    for (size_t i = 0; i < 6; i++)
+        EXPECT_EQ(expect[i], k[i]);
+}
@@ -0,0 +1,141 @@
+#include "tmatrix.h"
+
+#include <cmath>
+#include <limits>
+
+#include <gtest.h>
+
+namespace
+{
+template<typename T>
+TDynamicMatrix<T> naive_product(const TDynamicMatrix<T>& a, const TDynamicMatrix<T>& b)
+{
+    size_t n = a.size();
+    TDynamicMatrix<T> res(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            for (size_t k = 0; k < n; k++)
+                res[i][j] += a[i][k] * b[k][j];
+    return res;
+}
+
+template<typename T>
+TDynamicMatrix<T> filled(size_t n, int seed)
+{
+    TDynamicMatrix<T> m(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            m[i][j] = (T)(int)((i * 7 + j * 13 + seed) % 11) - 5;
+    return m;
+}
+
+// массив указателей на строки для TGemm
+template<typename T>
+std::vector<const T*> rows(const TDynamicMatrix<T>& m)
+{
+    std::vector<const T*> r(m.size());
+    for (size_t i = 0; i < m.size(); i++)
+        r[i] = m[i].data();
+    return r;
+}
+
+// временно меняет параметры умножения для типа T
+template<typename T>
+class TParamsGuard
+{
+    TGemmParams saved;
+public:
+    TParamsGuard() : saved(TGemmConfig<T>::params()) {}
+    ~TParamsGuard() { TGemmConfig<T>::params() = saved; }
+};
+}
+
+TEST(TGemm, blocked_product_matches_naive)
+{
+    TParamsGuard<int> guard;
+    TGemmConfig<int>::params().block_size = 8;
+    TDynamicMatrix<int> a = filled<int>(37, 1), b = filled<int>(37, 2);
+    EXPECT_EQ(naive_product(a, b), a * b);
+}
+
+TEST(TGemm, parallel_blocked_product_matches_naive)
+{
+    TParamsGuard<int> guard;
+    TGemmConfig<int>::params().block_size = 8;
+    TGemmConfig<int>::params().parallel_threshold = 16;
+    TDynamicMatrix<int> a = filled<int>(50, 3), b = filled<int>(50, 4);
+    EXPECT_EQ(naive_product(a, b), a * b);
+}
+
+TEST(TGemm, strassen_matches_naive_for_even_size)
+{
+    TParamsGuard<int> guard;
+    TGemmConfig<int>::params().strassen_threshold = 16;
+    TGemmConfig<int>::params().strassen_cutoff = 8;
+    TDynamicMatrix<int> a = filled<int>(64, 5), b = filled<int>(64, 6);
+    EXPECT_EQ(naive_product(a, b), a * b);
+}
+
+TEST(TGemm, strassen_matches_naive_for_odd_sizes)
+{
+    TParamsGuard<int> guard;
+    TGemmConfig<int>::params().strassen_threshold = 16;
+    TGemmConfig<int>::params().strassen_cutoff = 4;
+    for (size_t n : { 17, 45, 67 }) {
+        TDynamicMatrix<int> a = filled<int>(n, 7), b = filled<int>(n, 8);
+        EXPECT_EQ(naive_product(a, b), a * b) << "n = " << n;
+    }
+}
+
+TEST(TGemm, precision_check_reports_small_error_for_double)
+{
+    TParamsGuard<double> guard;
+    TGemmParams& p = TGemmConfig<double>::params();
+    p.strassen_threshold = 16;
+    p.strassen_cutoff = 8;
+    p.precision_check = true;
+    TDynamicMatrix<double> a = filled<double>(40, 9), b = filled<double>(40, 10);
+    TDynamicMatrix<double> c = a * b;
+    EXPECT_LT(TGemm<double>::last_error(), 1e-12);
+    TDynamicMatrix<double> expected = naive_product(a, b);
+    for (size_t i = 0; i < 40; i++)
+        for (size_t j = 0; j < 40; j++)
+            EXPECT_NEAR(expected[i][j], c[i][j], 1e-9);
+}
+
+TEST(TGemm, precision_check_flags_perturbed_product)
+{
+    const size_t n = 40;
+    TDynamicMatrix<double> a = filled<double>(n, 9), b = filled<double>(n, 10);
+    TDynamicMatrix<double> c = naive_product(a, b);
+    std::vector<const double*> ra = rows(a), rb = rows(b);
+    double tol = std::sqrt(std::numeric_limits<double>::epsilon());
+    EXPECT_LT(TGemm<double>::residual({ ra.data(), 0 }, { rb.data(), 0 }, { rows(c).data(), 0 }, n), 1e-15);
+    // один испорченный элемент - как у ядра, потерявшего слагаемое
+    c[7][11] += 1.0;
+    EXPECT_GT(TGemm<double>::residual({ ra.data(), 0 }, { rb.data(), 0 }, { rows(c).data(), 0 }, n), tol);
+}
+
+TEST(TGemm, precision_check_recomputes_result_above_tolerance)
+{
+    const size_t n = 40;
+    TDynamicMatrix<double> a(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            a[i][j] = 1.0 / double(i + 2 * j + 1);
+            b[i][j] = 1.0 / double(2 * i + j + 3);
+        }
+    TParamsGuard<double> guard;
+    TGemmParams& p = TGemmConfig<double>::params();
+    p.strassen_threshold = n + 1;
+    TDynamicMatrix<double> expected = a * b;
+    // ошибка округления Штрассена больше такого допуска - проверка
+    // должна ее заметить и пересчитать результат блочным умножением
+    p.strassen_threshold = 16;
+    p.strassen_cutoff = 8;
+    p.precision_check = true;
+    p.tolerance = 1e-30;
+    TDynamicMatrix<double> c = a * b;
+    EXPECT_GT(TGemm<double>::last_error(), p.tolerance);
+    EXPECT_EQ(expected, c);
+}
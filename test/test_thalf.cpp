@@ -0,0 +1,82 @@
+#include "thalf.h"
+
+#include <gtest.h>
+#include <cmath>
+
+TEST(THalf, converts_exact_values)
+{
+    for (float f : { 0.0f, 1.0f, -2.5f, 0.099975586f, 65504.0f, 6.1035156e-05f, 5.9604645e-08f })
+        EXPECT_EQ(f, float(THalf(f)));
+    EXPECT_EQ(0x3c00, THalf(1.0f).bits);
+}
+
+TEST(THalf, rounds_to_nearest_even_and_saturates_to_infinity)
+{
+    EXPECT_EQ(1.0f, float(THalf(1.0f + 1.0f / 4096)));
+    EXPECT_EQ(1.0f + 1.0f / 512, float(THalf(1.0f + 3.0f / 2048)));
+    EXPECT_TRUE(std::isinf(float(THalf(70000.0f))));
+    EXPECT_TRUE(std::isnan(float(THalf(std::nanf("")))));
+}
+
+TEST(TBFloat16, keeps_float_exponent_range)
+{
+    EXPECT_EQ(1.0f, float(TBFloat16(1.0f)));
+    EXPECT_EQ(0x3f80, TBFloat16(1.0f).bits);
+    EXPECT_NEAR(1e30f, float(TBFloat16(1e30f)), 1e28f);
+    EXPECT_EQ(1.0f, float(TBFloat16(1.0f + 1.0f / 512)));
+}
+
+TEST(THalf, bulk_conversion_matches_scalar_conversion)
+{
+    float src[37];
+    THalf h[37];
+    float back[37];
+    for (int i = 0; i < 37; i++)
+        src[i] = (float)i * 0.37f - 5.0f;
+    TConvert<float, THalf>::run(src, h, 37);
+    TConvert<THalf, float>::run(h, back, 37);
+    for (int i = 0; i < 37; i++) {
+        EXPECT_EQ(THalf(src[i]).bits, h[i].bits);
+        EXPECT_EQ(float(h[i]), back[i]);
+    }
+}
+
+TEST(THalf, half_vector_uses_half_the_memory_of_float)
+{
+    EXPECT_EQ(2u, sizeof(THalf));
+    EXPECT_EQ(2u, sizeof(TBFloat16));
+}
+
+TEST(THalf, matrix_product_accumulates_in_float)
+{
+    // при накоплении во float результат округляется в half один раз - при записи
+    const size_t n = 70;
+    TDynamicMatrix<THalf> a(n), b(n);
+    TDynamicMatrix<float> fa(n), fb(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            a[i][j] = THalf((float)((i + j) % 9) * 0.25f);
+            b[i][j] = THalf((float)((i * j) % 7) * 0.5f);
+            fa[i][j] = float(a[i][j]);
+            fb[i][j] = float(b[i][j]);
+        }
+    TDynamicMatrix<THalf> c = a * b;
+    TDynamicMatrix<float> fc = fa * fb;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            EXPECT_EQ(THalf(fc[i][j]).bits, c[i][j].bits);
+}
+
+TEST(TBFloat16, matrix_vector_product_accumulates_in_float)
+{
+    const size_t n = 300;
+    TDynamicMatrix<TBFloat16> a(n);
+    TDynamicVector<TBFloat16> x(n);
+    for (size_t i = 0; i < n; i++) {
+        x[i] = TBFloat16(1.0f);
+        for (size_t j = 0; j < n; j++)
+            a[i][j] = TBFloat16(1.0f);
+    }
+    TDynamicVector<TBFloat16> y = a * x;
+    EXPECT_EQ(300.0f, float(y[0]));
+}
@@ -0,0 +1,69 @@
+#include "thash.h"
+
+#include <string>
+
+#include <gtest.h>
+
+TEST(THasher, matches_reference_xxh64_values)
+{
+    THasher h;
+    EXPECT_EQ(0xEF46DB3751D8E999ull, h.digest());
+    h.update("a", 1);
+    EXPECT_EQ(0xD24EC4F1A98C6E5Bull, h.digest());
+    h.reset();
+    h.update("abc", 3);
+    EXPECT_EQ(0x44BC2CF5AD770999ull, h.digest());
+}
+
+TEST(THasher, streaming_does_not_depend_on_chunking)
+{
+    std::string s;
+    for (int i = 0; i < 1000; i++)
+        s += (char)(i * 7 + 3);
+    THasher whole;
+    whole.update(s.data(), s.size());
+    for (size_t step : { 1, 5, 31, 32, 33, 100 }) {
+        THasher parts;
+        for (size_t i = 0; i < s.size(); i += step)
+            parts.update(s.data() + i, std::min(step, s.size() - i));
+        EXPECT_EQ(whole.digest(), parts.digest());
+    }
+}
+
+TEST(THasher, seed_changes_hash)
+{
+    THasher a(0), b(1);
+    a.update("matrix", 6);
+    b.update("matrix", 6);
+    EXPECT_NE(a.digest(), b.digest());
+}
+
+TEST(THasher, equal_vectors_have_equal_hashes)
+{
+    TDynamicVector<double> a(100), b(100);
+    for (size_t i = 0; i < 100; i++)
+        a[i] = b[i] = i * 0.25;
+    EXPECT_EQ(content_hash(a), content_hash(b));
+    b[50] += 1.0;
+    EXPECT_NE(content_hash(a), content_hash(b));
+}
+
+TEST(THasher, size_is_part_of_hash)
+{
+    TDynamicVector<int> a(4), b(5);
+    TDynamicMatrix<int> c(2);
+    EXPECT_NE(content_hash(a), content_hash(b));
+    EXPECT_NE(content_hash(a), content_hash(c));
+}
+
+TEST(THasher, matrix_hash_follows_content)
+{
+    TDynamicMatrix<int> a(20);
+    for (size_t i = 0; i < 20; i++)
+        for (size_t j = 0; j < 20; j++)
+            a[i][j] = (int)(i * 20 + j);
+    TDynamicMatrix<int> b(a);
+    EXPECT_EQ(content_hash(a), content_hash(b));
+    b[19][0] = -1;
+    EXPECT_NE(content_hash(a), content_hash(b));
+}
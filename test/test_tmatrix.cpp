@@ -209,3 +209,18 @@ TEST(TDynamicMatrix, cant_subtract_matrixes_with_not_equal_size)
     EXPECT_THROW(matrix1 - matrix2, std::invalid_argument);
 }
 
+
+TEST(TDynamicMatrix, large_matrices_compare_in_parallel)
+{
+    const size_t n = 600;
+    TDynamicMatrix<int> a(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            a[i][j] = (int)(i ^ j);
+    TDynamicMatrix<int> b(a);
+    TParallelConfig::mode() = TExecMode::parallel;
+    EXPECT_EQ(a, b);
+    b[n / 2][n - 1] = -1;
+    EXPECT_NE(a, b);
+    TParallelConfig::mode() = TExecMode::automatic;
+}
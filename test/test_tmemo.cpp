@@ -0,0 +1,178 @@
+#include "tmemo.h"
+
+#include <thread>
+#include <vector>
+
+#include <gtest.h>
+
+namespace
+{
+TDynamicMatrix<int> sample(size_t n, int seed)
+{
+    TDynamicMatrix<int> m(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            m[i][j] = (int)((i * 5 + j * 3 + seed) % 13) - 6;
+    return m;
+}
+
+// включает кэш на время теста и выключает после
+struct TMemoScope
+{
+    explicit TMemoScope(size_t bytes)
+    {
+        TMemoCache<int>::instance().clear();
+        TMemoCache<int>::instance().reset_stats();
+        TMemoCache<int>::instance().set_capacity(bytes);
+    }
+    ~TMemoScope()
+    {
+        TMemoCache<int>::instance().set_capacity(0);
+        TMemoCache<int>::instance().clear();
+    }
+};
+}
+
+TEST(TMemoCache, is_disabled_by_default)
+{
+    TDynamicMatrix<int> a = sample(4, 1);
+    EXPECT_FALSE(TMemoCache<int>::instance().enabled());
+    EXPECT_EQ(a * a, memo_multiply(a, a).matrix());
+    EXPECT_EQ(0u, TMemoCache<int>::instance().stats().misses);
+}
+
+TEST(TMemoCache, repeated_product_is_a_hit_sharing_the_buffer)
+{
+    TMemoScope scope(1 << 20);
+    TDynamicMatrix<int> a = sample(10, 1), b = sample(10, 2);
+    TCowMatrix<int> first = memo_multiply(a, b);
+    TCowMatrix<int> second = memo_multiply(a, b);
+    EXPECT_EQ(a * b, second.matrix());
+    EXPECT_EQ(&first.matrix(), &second.matrix());
+    TMemoStats s = TMemoCache<int>::instance().stats();
+    EXPECT_EQ(1u, s.hits);
+    EXPECT_EQ(1u, s.misses);
+    EXPECT_EQ(1u, s.entries);
+    EXPECT_EQ(100 * sizeof(int), s.bytes);
+}
+
+TEST(TMemoCache, operation_and_operand_order_are_part_of_key)
+{
+    TMemoScope scope(1 << 20);
+    TDynamicMatrix<int> a = sample(6, 3), b = sample(6, 4);
+    EXPECT_EQ(a * b, memo_multiply(a, b).matrix());
+    EXPECT_EQ(b * a, memo_multiply(b, a).matrix());
+    EXPECT_EQ(a + b, memo_add(a, b).matrix());
+    EXPECT_EQ(a - b, memo_sub(a, b).matrix());
+    EXPECT_EQ(0u, TMemoCache<int>::instance().stats().hits);
+    EXPECT_EQ(4u, TMemoCache<int>::instance().stats().entries);
+}
+
+TEST(TMemoCache, changed_operand_misses)
+{
+    TMemoScope scope(1 << 20);
+    TDynamicMatrix<int> a = sample(6, 5);
+    memo_multiply(a, a);
+    a[2][3] += 1;
+    EXPECT_EQ(a * a, memo_multiply(a, a).matrix());
+    EXPECT_EQ(2u, TMemoCache<int>::instance().stats().misses);
+}
+
+TEST(TMemoCache, writing_to_result_does_not_change_cache)
+{
+    TMemoScope scope(1 << 20);
+    TDynamicMatrix<int> a = sample(5, 6);
+    TCowMatrix<int> r = memo_multiply(a, a);
+    r[0][0] = 1000;
+    EXPECT_EQ(a * a, memo_multiply(a, a).matrix());
+}
+
+TEST(TMemoCache, evicts_least_recently_used_when_full)
+{
+    TMemoScope scope(2 * 16 * sizeof(int));
+    TDynamicMatrix<int> a = sample(4, 1), b = sample(4, 2), c = sample(4, 3);
+    memo_multiply(a, a);
+    memo_multiply(b, b);
+    memo_multiply(a, a);         // a становится недавно использованной
+    memo_multiply(c, c);         // вытесняет b
+    TMemoStats s = TMemoCache<int>::instance().stats();
+    EXPECT_EQ(1u, s.evictions);
+    EXPECT_EQ(2u, s.entries);
+    memo_multiply(a, a);
+    EXPECT_EQ(2u, TMemoCache<int>::instance().stats().hits);
+    memo_multiply(b, b);
+    EXPECT_EQ(4u, TMemoCache<int>::instance().stats().misses);
+}
+
+TEST(TMemoCache, results_larger_than_capacity_are_not_stored)
+{
+    TMemoScope scope(10 * sizeof(int));
+    TDynamicMatrix<int> a = sample(4, 1);
+    memo_multiply(a, a);
+    EXPECT_EQ(0u, TMemoCache<int>::instance().stats().entries);
+}
+
+TEST(TMemoCache, lookups_are_thread_safe)
+{
+    TMemoScope scope(1 << 20);
+    std::vector<TDynamicMatrix<int>> ms;
+    for (int s = 0; s < 4; s++)
+        ms.push_back(sample(12, s));
+    std::vector<std::thread> threads;
+    std::vector<int> ok(4, 1);
+    for (int t = 0; t < 4; t++)
+        threads.emplace_back([&, t]() {
+            for (int r = 0; r < 50; r++) {
+                const TDynamicMatrix<int>& m = ms[(t + r) % 4];
+                if (memo_multiply(m, m).matrix() != m * m)
+                    ok[t] = 0;
+            }
+        });
+    for (auto& th : threads)
+        th.join();
+    for (int t = 0; t < 4; t++)
+        EXPECT_EQ(1, ok[t]);
+    TMemoStats s = TMemoCache<int>::instance().stats();
+    EXPECT_EQ(200u, s.hits + s.misses);
+    EXPECT_EQ(4u, s.entries);
+}
+
+TEST(TMemoCache, summation_policy_is_part_of_key)
+{
+    TMemoCache<double>& cache = TMemoCache<double>::instance();
+    cache.clear();
+    cache.reset_stats();
+    cache.set_capacity(1 << 20);
+    TSumPolicy saved = TSumConfig<double>::policy();
+    TDynamicMatrix<double> a(8);
+    for (size_t i = 0; i < 8; i++)
+        for (size_t j = 0; j < 8; j++)
+            a[i][j] = 1.0 / double(i + j + 1);
+    TSumConfig<double>::policy() = TSumPolicy::kahan;
+    memo_multiply(a, a);
+    TSumConfig<double>::policy() = TSumPolicy::naive;
+    TDynamicMatrix<double> naive = memo_multiply(a, a).matrix();
+    TSumConfig<double>::policy() = saved;
+    TMemoStats s = cache.stats();
+    cache.set_capacity(0);
+    cache.clear();
+    EXPECT_EQ(0u, s.hits);
+    EXPECT_EQ(2u, s.misses);
+    EXPECT_EQ(2u, s.entries);
+    EXPECT_EQ(a * a, naive);
+}
+
+TEST(TMemoCache, gemm_params_are_part_of_key)
+{
+    TMemoScope scope(1 << 20);
+    TDynamicMatrix<int> a = sample(6, 7);
+    TGemmParams saved = TGemmConfig<int>::params();
+    memo_multiply(a, a);
+    TGemmConfig<int>::params().block_size = 2;
+    memo_multiply(a, a);
+    TGemmConfig<int>::params() = saved;
+    memo_multiply(a, a);
+    TMemoStats s = TMemoCache<int>::instance().stats();
+    EXPECT_EQ(2u, s.misses);
+    EXPECT_EQ(1u, s.hits);
+}
@@ -0,0 +1,109 @@
+#include "tmatrix.h"
+
+#include <thread>
+
+#include <gtest.h>
+
+TEST(TMetrics, snapshot_after_reset_is_empty)
+{
+    TMetrics::reset();
+    TMetricsSnapshot s = TMetrics::snapshot();
+    for (size_t op = 0; op < TMetricOp::COUNT; op++) {
+        EXPECT_EQ(0u, s[op].calls);
+        EXPECT_EQ(0u, s[op].allocations);
+    }
+}
+
+TEST(TMetrics, scope_records_work_and_allocations)
+{
+    TMetrics::reset();
+    {
+        TMetricScope scope(TMetricOp::gemv, 10, 200, 800);
+        TMetrics::allocation(64);
+    }
+    TMetrics::allocation(16);
+    TMetricsSnapshot s = TMetrics::snapshot();
+    EXPECT_EQ(1u, s[TMetricOp::gemv].calls);
+    EXPECT_EQ(10u, s[TMetricOp::gemv].elements);
+    EXPECT_EQ(200u, s[TMetricOp::gemv].flops);
+    EXPECT_EQ(800u, s[TMetricOp::gemv].bytes);
+    EXPECT_EQ(1u, s[TMetricOp::gemv].allocations);
+    EXPECT_EQ(64u, s[TMetricOp::gemv].alloc_bytes);
+    EXPECT_EQ(1u, s[TMetricOp::none].allocations);
+    EXPECT_EQ(16u, s[TMetricOp::none].alloc_bytes);
+}
+
+TEST(TMetrics, counters_of_finished_threads_are_kept)
+{
+    TMetrics::reset();
+    std::thread t([]() {
+        TMetricScope scope(TMetricOp::dot, 1, 6, 48);
+    });
+    t.join();
+    TMetricsSnapshot s = TMetrics::snapshot();
+    EXPECT_EQ(1u, s[TMetricOp::dot].calls);
+    EXPECT_EQ(6u, s[TMetricOp::dot].flops);
+}
+
+TEST(TMetrics, operation_names)
+{
+    EXPECT_STREQ("gemm", TMetricOp::name(TMetricOp::gemm));
+    EXPECT_STREQ("none", TMetricOp::name(TMetricOp::none));
+}
+
+#if defined(TMATRIX_ENABLE_METRICS)
+TEST(TMetrics, operators_are_instrumented)
+{
+    const size_t n = 20;
+    TDynamicMatrix<double> a(n), b(n);
+    TDynamicVector<double> v(n);
+    TMetrics::reset();
+    TDynamicMatrix<double> c = a * b;
+    TDynamicVector<double> w = a * v;
+    TDynamicVector<double> u = v + v;
+    TMetricsSnapshot s = TMetrics::snapshot();
+    EXPECT_EQ(1u, s[TMetricOp::gemm].calls);
+    EXPECT_EQ(2 * n * n * n, s[TMetricOp::gemm].flops);
+    EXPECT_EQ(3 * n * n * sizeof(double), s[TMetricOp::gemm].bytes);
+    // массив строк результата и n строк
+    EXPECT_EQ(n + 1, s[TMetricOp::gemm].allocations);
+    EXPECT_EQ(1u, s[TMetricOp::gemv].calls);
+    // dot строк внутри gemv - вложенные области, они не записываются
+    EXPECT_EQ(0u, s[TMetricOp::dot].calls);
+    EXPECT_EQ(0u, s[TMetricOp::dot].nanoseconds);
+    EXPECT_EQ(1u, s[TMetricOp::gemv].allocations);
+    EXPECT_EQ(1u, s[TMetricOp::vector_add].calls);
+    EXPECT_EQ(n, s[TMetricOp::vector_add].elements);
+}
+
+TEST(TMetrics, pool_tasks_work_for_enclosing_operation)
+{
+    const size_t n = 64;
+    TExecMode old = TParallelConfig::mode();
+    TParallelConfig::mode() = TExecMode::parallel;
+    TDynamicMatrix<double> a(n);
+    TDynamicVector<double> v(n);
+    TMetrics::reset();
+    TDynamicVector<double> w = a * v;
+    TMetricsSnapshot s = TMetrics::snapshot();
+    TParallelConfig::mode() = old;
+    EXPECT_EQ(1u, s[TMetricOp::gemv].calls);
+    EXPECT_EQ(0u, s[TMetricOp::dot].calls);
+}
+#endif
+
+TEST(TMetrics, nested_scopes_are_not_recorded)
+{
+    TMetrics::reset();
+    {
+        TMetricScope outer(TMetricOp::gemv, 4, 32, 160);
+        TMetricScope inner(TMetricOp::dot, 1, 8, 64);
+        TMetrics::allocation(32);
+    }
+    TMetricsSnapshot s = TMetrics::snapshot();
+    EXPECT_EQ(1u, s[TMetricOp::gemv].calls);
+    EXPECT_EQ(1u, s[TMetricOp::gemv].allocations);
+    EXPECT_EQ(0u, s[TMetricOp::dot].calls);
+    EXPECT_EQ(0u, s[TMetricOp::dot].nanoseconds);
+    EXPECT_EQ(TMetricOp::none, TMetrics::current());
+}
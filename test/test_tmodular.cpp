@@ -0,0 +1,151 @@
+#include "tmodular.h"
+
+#include <gtest.h>
+
+namespace
+{
+typedef TModular<998244353> F;
+typedef TModular<2147483647> G;
+
+template<uint32_t P>
+TDynamicMatrix<TModular<P>> sample(size_t n, long long seed)
+{
+    TDynamicMatrix<TModular<P>> m(n);
+    unsigned long long x = (unsigned long long)seed;
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            x = x * 6364136223846793005ull + 1442695040888963407ull;
+            m[i][j] = TModular<P>((long long)(x >> 33));
+        }
+    return m;
+}
+
+// произведение с приведением после каждого слагаемого
+template<uint32_t P>
+TDynamicMatrix<TModular<P>> naive_product(const TDynamicMatrix<TModular<P>>& a, const TDynamicMatrix<TModular<P>>& b)
+{
+    size_t n = a.size();
+    TDynamicMatrix<TModular<P>> c(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            unsigned long long s = 0;
+            for (size_t k = 0; k < n; k++)
+                s = (s + (unsigned long long)a[i][k].value() * b[k][j].value()) % P;
+            c[i][j] = TModular<P>((long long)s);
+        }
+    return c;
+}
+}
+
+TEST(TModular, converts_to_and_from_montgomery_form)
+{
+    EXPECT_EQ(0u, F(0).value());
+    EXPECT_EQ(12345u, F(12345).value());
+    EXPECT_EQ(998244352u, F(-1).value());
+    EXPECT_EQ(1u, F(998244354LL).value());
+    EXPECT_EQ(2147483646u, G(-1).value());
+}
+
+TEST(TModular, arithmetic_matches_modular_definition)
+{
+    const unsigned long long p = 998244353;
+    long long xs[] = { 0, 1, 2, 12345, 998244352, 500000000, 777777777 };
+    for (long long x : xs)
+        for (long long y : xs) {
+            EXPECT_EQ((x + y) % p, F(x + y).value());
+            EXPECT_EQ((F(x) + F(y)).value(), (x + y) % p);
+            EXPECT_EQ((F(x) - F(y)).value(), (x - y + p) % p);
+            EXPECT_EQ((F(x) * F(y)).value(), (unsigned long long)x * y % p);
+        }
+}
+
+TEST(TModular, inverse_and_division)
+{
+    F a(123456789);
+    EXPECT_EQ(1u, (a * a.inv()).value());
+    EXPECT_EQ(7u, (F(7) * a / a).value());
+    EXPECT_EQ(1u, G(5).pow(2147483646).value());
+    ASSERT_ANY_THROW(F(0).inv());
+}
+
+TEST(TModular, matrix_product_matches_naive_reduction)
+{
+    for (size_t n : { 1, 5, 40, 200 }) {
+        TDynamicMatrix<F> a = sample<998244353>(n, 1), b = sample<998244353>(n, 2);
+        EXPECT_EQ(naive_product(a, b), a * b);
+    }
+}
+
+TEST(TModular, matrix_product_does_not_overflow_for_31_bit_modulus)
+{
+    const size_t n = 150;
+    TDynamicMatrix<G> a(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            a[i][j] = G(-1 - (long long)((i + j) % 3));
+            b[i][j] = G(-1 - (long long)((i * j) % 5));
+        }
+    EXPECT_EQ(naive_product(a, b), a * b);
+}
+
+TEST(TModular, matrix_vector_product)
+{
+    const size_t n = 33;
+    TDynamicMatrix<F> a = sample<998244353>(n, 3);
+    TDynamicVector<F> v(n);
+    for (size_t i = 0; i < n; i++)
+        v[i] = F((long long)i * 1000003);
+    TDynamicVector<F> r = a * v;
+    for (size_t i = 0; i < n; i++) {
+        F s;
+        for (size_t k = 0; k < n; k++)
+            s += a[i][k] * v[k];
+        EXPECT_EQ(s, r[i]);
+    }
+}
+
+TEST(TModular, determinant_of_triangular_matrix_is_product_of_diagonal)
+{
+    TDynamicMatrix<F> m = sample<998244353>(6, 4);
+    for (size_t i = 0; i < 6; i++)
+        for (size_t j = 0; j < i; j++)
+            m[i][j] = F(0);
+    F d(1);
+    for (size_t i = 0; i < 6; i++)
+        d *= m[i][i];
+    EXPECT_EQ(d, TModularAlgebra<998244353>::det(m));
+}
+
+TEST(TModular, determinant_changes_sign_when_rows_swap)
+{
+    TDynamicMatrix<F> m(2);
+    m[0][1] = F(3);
+    m[1][0] = F(5);
+    EXPECT_EQ(F(-15), TModularAlgebra<998244353>::det(m));
+}
+
+TEST(TModular, determinant_is_multiplicative)
+{
+    TDynamicMatrix<F> a = sample<998244353>(30, 5), b = sample<998244353>(30, 6);
+    EXPECT_EQ(TModularAlgebra<998244353>::det(a) * TModularAlgebra<998244353>::det(b),
+        TModularAlgebra<998244353>::det(a * b));
+}
+
+TEST(TModular, determinant_of_singular_matrix_is_zero)
+{
+    TDynamicMatrix<F> m = sample<998244353>(5, 7);
+    m[3] = m[1];
+    EXPECT_EQ(F(0), TModularAlgebra<998244353>::det(m));
+    ASSERT_ANY_THROW(TModularAlgebra<998244353>::inverse(m));
+}
+
+TEST(TModular, inverse_gives_identity)
+{
+    for (size_t n : { 1, 8, 150 }) {
+        TDynamicMatrix<F> a = sample<998244353>(n, 8);
+        TDynamicMatrix<F> e(n);
+        for (size_t i = 0; i < n; i++)
+            e[i][i] = F(1);
+        EXPECT_EQ(e, a * TModularAlgebra<998244353>::inverse(a));
+    }
+}
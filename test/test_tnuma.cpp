@@ -0,0 +1,205 @@
+#include "tmatrix.h"
+
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gtest.h>
+
+namespace
+{
+    // политика размещения и режим циклов на время теста
+    struct TPolicyGuard
+    {
+        TNumaPolicy policy;
+        TExecMode mode;
+
+        TPolicyGuard(TNumaPolicy p, TExecMode m) : policy(TNumaConfig::policy()), mode(TParallelConfig::mode())
+        {
+            TNumaConfig::policy() = p;
+            TParallelConfig::mode() = m;
+        }
+        ~TPolicyGuard()
+        {
+            TNumaConfig::policy() = policy;
+            TParallelConfig::mode() = mode;
+        }
+    };
+
+    TDynamicMatrix<double> filled(size_t n)
+    {
+        TDynamicMatrix<double> m(n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                m[i][j] = double(i * n + j) / 7.0;
+        return m;
+    }
+}
+
+TEST(TNuma, default_policy_is_local)
+{
+    EXPECT_EQ(TNumaPolicy::local, TNumaConfig::policy());
+}
+
+TEST(TNuma, topology_is_consistent)
+{
+    size_t n = TNuma::nodes();
+    ASSERT_GE(n, 1u);
+    int cur = TNuma::current_node();
+    EXPECT_GE(cur, -1);
+    EXPECT_LT(cur, (int)n);
+    EXPECT_FALSE(TNuma::bind_thread(n));
+}
+
+TEST(TNuma, workers_are_split_between_nodes_in_order)
+{
+    const size_t workers = 15;
+    size_t prev = 0;
+    for (size_t w = 0; w < workers; w++) {
+        size_t node = TNuma::node_of_worker(w, workers);
+        EXPECT_LT(node, TNuma::nodes());
+        EXPECT_GE(node, prev);
+        prev = node;
+    }
+}
+
+TEST(TNuma, interleave_needs_whole_pages)
+{
+    char small[16];
+    EXPECT_FALSE(TNuma::interleave(small, sizeof(small)));
+    // на системах без mbind или без прав вызов просто не выполняется
+    std::vector<char> big(16 * TNuma::PAGE);
+    TNuma::interleave(big.data(), big.size());
+    SUCCEED();
+}
+
+TEST(TNuma, interleaved_mapping_is_page_aligned_and_zeroed)
+{
+    const size_t bytes = 3 * TNuma::PAGE + 100;
+    char* p = static_cast<char*>(TNuma::map_interleaved(bytes));
+#if defined(__linux__)
+    ASSERT_NE(nullptr, p);
+#endif
+    if (!p)
+        return;
+    EXPECT_EQ(0u, (uintptr_t)p % TNuma::PAGE);
+    EXPECT_EQ(0, p[bytes - 1]);
+    p[bytes - 1] = 1;
+    TNuma::unmap(p, bytes);
+}
+
+TEST(TNuma, interleaved_vectors_move_and_swap)
+{
+    TPolicyGuard g(TNumaPolicy::interleave, TExecMode::automatic);
+    TDynamicVector<double> a(10000), b(20000);
+    a[9999] = 1.0;
+    b[19999] = 2.0;
+    swap(a, b);
+    EXPECT_EQ(2.0, a[19999]);
+    TDynamicVector<double> c(std::move(b));
+    EXPECT_EQ(1.0, c[9999]);
+    c = a;
+    EXPECT_EQ(a, c);
+}
+
+TEST(TNuma, first_touch_vector_is_zero_initialized)
+{
+    TPolicyGuard g(TNumaPolicy::first_touch, TExecMode::parallel);
+    TDynamicVector<double> v(100000);
+    for (size_t i = 0; i < v.size(); i += 997)
+        EXPECT_EQ(0.0, v[i]);
+    TDynamicVector<double> c(v);
+    EXPECT_EQ(v, c);
+    TDynamicVector<double> small(3), assigned(5);
+    assigned = v;
+    EXPECT_EQ(v, assigned);
+    EXPECT_EQ(0.0, small[2]);
+}
+
+TEST(TNuma, first_touch_matrix_operations_are_correct)
+{
+    TDynamicMatrix<double> a = filled(40), b = filled(40);
+    TDynamicMatrix<double> expect_sum = a + b, expect_diff = a - b * 2.0, expect_prod = a * b;
+    TDynamicVector<double> x(40);
+    for (size_t i = 0; i < 40; i++)
+        x[i] = double(i) - 3.5;
+    TDynamicVector<double> expect_gemv = a * x;
+    TPolicyGuard g(TNumaPolicy::first_touch, TExecMode::parallel);
+    TDynamicMatrix<double> c = filled(40), d(c);
+    EXPECT_EQ(a, c);
+    EXPECT_EQ(a, d);
+    EXPECT_EQ(expect_sum, c + d);
+    EXPECT_EQ(expect_diff, c - d * 2.0);
+    EXPECT_EQ(expect_prod, c * d);
+    EXPECT_EQ(expect_gemv, c * x);
+}
+
+TEST(TNuma, interleave_matrix_operations_are_correct)
+{
+    TDynamicMatrix<double> a = filled(30);
+    TDynamicMatrix<double> expect = a * a;
+    TPolicyGuard g(TNumaPolicy::interleave, TExecMode::parallel);
+    TDynamicMatrix<double> b = filled(30);
+    TDynamicVector<double> v(1 << 16);
+    EXPECT_EQ(expect, b * b);
+    EXPECT_EQ(0.0, v[(1 << 16) - 1]);
+}
+
+TEST(TNuma, affine_chunks_run_on_the_same_thread)
+{
+    if (TThreadPool::instance().threads() == 0)
+        return;
+    TPolicyGuard g(TNumaPolicy::first_touch, TExecMode::parallel);
+    size_t chunks = TThreadPool::instance().threads() + 1;
+    std::vector<std::thread::id> first(chunks), second(chunks);
+    std::mutex mtx;
+    auto record = [&](std::vector<std::thread::id>& ids) {
+        parallel_for(0, chunks, 1, [&](size_t b, size_t e) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            std::lock_guard<std::mutex> lk(mtx);
+            for (size_t c = b; c < e; c++)
+                ids[c] = std::this_thread::get_id();
+        });
+    };
+    record(first);
+    record(second);
+    EXPECT_EQ(first, second);
+    // кусок 0 выполняет вызывающий поток, остальные - потоки пула
+    EXPECT_EQ(std::this_thread::get_id(), first[0]);
+    for (size_t c = 1; c < chunks; c++)
+        EXPECT_NE(std::this_thread::get_id(), first[c]);
+}
+
+TEST(TNuma, affine_nested_loops_complete)
+{
+    TPolicyGuard g(TNumaPolicy::first_touch, TExecMode::parallel);
+    std::atomic<size_t> total(0);
+    parallel_for(0, 8, 1, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; i++)
+            parallel_for(0, 100, 1, [&](size_t x, size_t y) { total += y - x; });
+    });
+    EXPECT_EQ(800u, total.load());
+}
+
+#if defined(__linux__)
+TEST(TNuma, binding_narrows_and_restores_thread_mask)
+{
+    std::thread t([]() {
+        cpu_set_t before, bound, after;
+        ASSERT_EQ(0, sched_getaffinity(0, sizeof(before), &before));
+        if (!TNuma::bind_thread(0))
+            return;
+        ASSERT_EQ(0, sched_getaffinity(0, sizeof(bound), &bound));
+        EXPECT_GT(CPU_COUNT(&bound), 0);
+        // привязка не добавляет процессоры, запрещенные потоку
+        for (int c = 0; c < CPU_SETSIZE; c++)
+            if (CPU_ISSET(c, &bound)) {
+                EXPECT_TRUE(CPU_ISSET(c, &before));
+            }
+        TNuma::unbind_thread();
+        ASSERT_EQ(0, sched_getaffinity(0, sizeof(after), &after));
+        EXPECT_TRUE(CPU_EQUAL(&before, &after));
+    });
+    t.join();
+}
+#endif
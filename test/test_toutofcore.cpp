@@ -0,0 +1,145 @@
+#include "toutofcore.h"
+
+#include <cstdio>
+
+#include <gtest.h>
+
+namespace
+{
+    TDynamicMatrix<long long> filled(size_t n, int seed)
+    {
+        TDynamicMatrix<long long> m(n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                m[i][j] = (long long)((i * 7 + j * 3 + seed) % 13) - 6;
+        return m;
+    }
+
+    // удаляет временные файлы теста
+    struct TTempFiles
+    {
+        std::vector<std::string> names;
+        std::string add(const std::string& s) { names.push_back(s); return s; }
+        ~TTempFiles()
+        {
+            for (const std::string& s : names)
+                std::remove(s.c_str());
+        }
+    };
+
+    const size_t TILE_BYTES = 4 * 4 * sizeof(long long);
+}
+
+TEST(TTiledFile, new_file_is_zero)
+{
+    TTempFiles tmp;
+    TTiledFile<long long> f(tmp.add("ooc_zero.bin"), 10, 4);
+    EXPECT_EQ(10u, f.size());
+    EXPECT_EQ(4u, f.tile());
+    EXPECT_EQ(3u, f.tiles());
+    EXPECT_EQ(TDynamicMatrix<long long>(4), f.read_tile(2, 2));
+}
+
+TEST(TTiledFile, tiles_round_trip_and_reopen)
+{
+    TTempFiles tmp;
+    std::string path = tmp.add("ooc_reopen.bin");
+    TDynamicMatrix<long long> m = filled(10, 1);
+    {
+        TTiledFile<long long> f(path, 10, 4);
+        f.assign(m);
+    }
+    TTiledFile<long long> g(path);
+    EXPECT_EQ(10u, g.size());
+    EXPECT_EQ(m, g.to_matrix());
+    // краевая плитка дополнена нулями
+    TDynamicMatrix<long long> edge = g.read_tile(2, 0);
+    EXPECT_EQ(m[8][0], edge[0][0]);
+    EXPECT_EQ(0, edge[2][0]);
+}
+
+TEST(TTiledFile, rejects_bad_arguments)
+{
+    TTempFiles tmp;
+    EXPECT_THROW(TTiledFile<long long>(tmp.add("ooc_bad.bin"), 10, 0), std::out_of_range);
+    // плитка читается в TDynamicMatrix, которой нужен размер меньше MAX_MATRIX_SIZE
+    EXPECT_THROW(TTiledFile<long long>(tmp.add("ooc_bad3.bin"), 10, MAX_MATRIX_SIZE), std::out_of_range);
+    TTiledFile<long long> f(tmp.add("ooc_bad2.bin"), 10, 4);
+    TDynamicMatrix<long long> wrong(3);
+    EXPECT_THROW(f.read_tile(0, 0, wrong), std::invalid_argument);
+    EXPECT_THROW(f.read_tile(3, 0), std::out_of_range);
+    EXPECT_THROW(TTiledFile<long long>("no_such_tiled_file.bin"), std::runtime_error);
+}
+
+TEST(TTiledFile, rejects_other_element_size)
+{
+    TTempFiles tmp;
+    std::string path = tmp.add("ooc_elem.bin");
+    {
+        TTiledFile<long long> f(path, 4, 2);
+    }
+    EXPECT_THROW(TTiledFile<int>{ path }, std::runtime_error);
+}
+
+TEST(TOutOfCore, multiply_matches_in_memory)
+{
+    TTempFiles tmp;
+    const size_t n = 19;
+    TDynamicMatrix<long long> a = filled(n, 1), b = filled(n, 5);
+    TTiledFile<long long> fa(tmp.add("ooc_a.bin"), n, 4), fb(tmp.add("ooc_b.bin"), n, 4), fc(tmp.add("ooc_c.bin"), n, 4);
+    fa.assign(a);
+    fb.assign(b);
+    TOutOfCoreStats st = out_of_core_multiply(fa, fb, fc, 20 * TILE_BYTES);
+    EXPECT_EQ(2u, st.block);
+    EXPECT_EQ(a * b, fc.to_matrix());
+}
+
+TEST(TOutOfCore, result_does_not_depend_on_budget)
+{
+    TTempFiles tmp;
+    const size_t n = 13;
+    TDynamicMatrix<long long> a = filled(n, 2), b = filled(n, 3);
+    TTiledFile<long long> fa(tmp.add("ooc_ba.bin"), n, 4), fb(tmp.add("ooc_bb.bin"), n, 4), fc(tmp.add("ooc_bc.bin"), n, 4);
+    fa.assign(a);
+    fb.assign(b);
+    for (size_t tiles : { 7, 20, 100 }) {
+        out_of_core_multiply(fa, fb, fc, tiles * TILE_BYTES);
+        EXPECT_EQ(a * b, fc.to_matrix());
+    }
+}
+
+TEST(TOutOfCore, larger_block_reads_less)
+{
+    TTempFiles tmp;
+    const size_t n = 32;
+    TTiledFile<long long> fa(tmp.add("ooc_ia.bin"), n, 4), fb(tmp.add("ooc_ib.bin"), n, 4), fc(tmp.add("ooc_ic.bin"), n, 4);
+    fa.assign(filled(n, 1));
+    fb.assign(filled(n, 2));
+    const size_t nt = 8;
+    TOutOfCoreStats one = out_of_core_multiply(fa, fb, fc, 7 * TILE_BYTES);
+    TOutOfCoreStats four = out_of_core_multiply(fa, fb, fc, 49 * TILE_BYTES);
+    EXPECT_EQ(1u, one.block);
+    EXPECT_EQ(4u, four.block);
+    EXPECT_EQ(nt * nt, one.tile_writes);
+    EXPECT_EQ(nt * nt, four.tile_writes);
+    // 2 nt^3 / q чтений без учета повторно использованных панелей A
+    EXPECT_LE(four.tile_reads, 2 * nt * nt * nt / 4);
+    EXPECT_LT(four.tile_reads * 3, one.tile_reads);
+}
+
+TEST(TOutOfCore, rejects_small_budget_and_mismatch)
+{
+    TTempFiles tmp;
+    TTiledFile<long long> fa(tmp.add("ooc_ma.bin"), 8, 4), fb(tmp.add("ooc_mb.bin"), 8, 2), fc(tmp.add("ooc_mc.bin"), 8, 4);
+    EXPECT_THROW(out_of_core_multiply(fa, fa, fc, 6 * TILE_BYTES), std::invalid_argument);
+    EXPECT_THROW(out_of_core_multiply(fa, fb, fc, 100 * TILE_BYTES), std::invalid_argument);
+}
+
+TEST(TOutOfCore, empty_matrices_need_no_budget)
+{
+    TTempFiles tmp;
+    TTiledFile<long long> fa(tmp.add("ooc_ea.bin"), 0, 4), fb(tmp.add("ooc_eb.bin"), 0, 4), fc(tmp.add("ooc_ec.bin"), 0, 4);
+    TOutOfCoreStats st = out_of_core_multiply(fa, fb, fc, 0);
+    EXPECT_EQ(0u, st.tile_reads);
+    EXPECT_EQ(0u, st.tile_writes);
+}
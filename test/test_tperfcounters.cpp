@@ -0,0 +1,140 @@
+#include "tmatrix.h"
+
+#include <sstream>
+
+#include <gtest.h>
+
+namespace
+{
+const TPerfTotals* find(const std::vector<std::pair<std::string, TPerfTotals>>& r, const std::string& op)
+{
+    for (const auto& e : r)
+        if (e.first == op)
+            return &e.second;
+    return nullptr;
+}
+}
+
+TEST(TPerfCounters, scope_records_calls_and_time)
+{
+    TPerfCounters::instance().reset();
+    {
+        TPerfScope s("test_scope");
+    }
+    {
+        TPerfScope s("test_scope");
+    }
+    auto r = TPerfCounters::instance().report();
+    const TPerfTotals* t = find(r, "test_scope");
+    ASSERT_NE(nullptr, t);
+    EXPECT_EQ(2u, t->calls);
+    EXPECT_GE(t->seconds, 0.0);
+}
+
+TEST(TPerfCounters, events_are_valid_only_when_available)
+{
+    TPerfCounters::instance().reset();
+    {
+        TPerfScope s("loop");
+        volatile double x = 0;
+        for (int i = 0; i < 100000; i++)
+            x = x + i;
+    }
+    const TPerfTotals* t = find(TPerfCounters::instance().report(), "loop");
+    ASSERT_NE(nullptr, t);
+    if (TPerfCounters::available()) {
+        EXPECT_TRUE(t->valid[TPerfEvent::cycles] || t->valid[TPerfEvent::instructions]);
+        if (t->valid[TPerfEvent::instructions]) {
+            EXPECT_GT(t->values[TPerfEvent::instructions], 100000u);
+        }
+    }
+    else {
+        for (size_t e = 0; e < TPerfEvent::COUNT; e++)
+            EXPECT_FALSE(t->valid[e]);
+    }
+}
+
+#if defined(TMATRIX_ENABLE_PERF_COUNTERS)
+TEST(TPerfCounters, kernels_are_instrumented)
+{
+    TDynamicMatrix<double> a(8), b(8);
+    TDynamicVector<double> v(8);
+    TPerfCounters::instance().reset();
+    TDynamicMatrix<double> c = a * b;
+    TDynamicVector<double> w = a * v;
+    c = a + b;
+    c = a - b;
+    auto r = TPerfCounters::instance().report();
+    for (const char* op : { "gemm", "gemv", "matrix_add", "matrix_sub" })
+        EXPECT_NE(nullptr, find(r, op)) << op;
+    EXPECT_EQ(1u, find(r, "gemm")->calls);
+    // dot внутри gemv - вложенная область, она не записывается
+    EXPECT_EQ(nullptr, find(r, "dot"));
+    double d = v * v;
+    (void)d;
+    EXPECT_EQ(1u, find(TPerfCounters::instance().report(), "dot")->calls);
+}
+
+TEST(TPerfCounters, nested_scopes_are_not_recorded)
+{
+    TPerfCounters::instance().reset();
+    {
+        TPerfScope outer("outer");
+        TPerfScope inner("inner");
+    }
+    auto r = TPerfCounters::instance().report();
+    EXPECT_NE(nullptr, find(r, "outer"));
+    EXPECT_EQ(nullptr, find(r, "inner"));
+}
+
+TEST(TPerfCounters, pool_tasks_count_toward_enclosing_scope)
+{
+    TPerfCounters::instance().reset();
+    {
+        TPerfScope s("pool_work");
+        TTaskGroup g;
+        for (int t = 0; t < 4; t++)
+            g.run([]() {
+                volatile double x = 0;
+                for (int i = 0; i < 200000; i++)
+                    x = x + i;
+                // задача внутри области не записывает свои области
+                TPerfScope inner("pool_inner");
+            });
+        g.wait();
+    }
+    auto r = TPerfCounters::instance().report();
+    const TPerfTotals* t = find(r, "pool_work");
+    ASSERT_NE(nullptr, t);
+    EXPECT_EQ(1u, t->calls);
+    EXPECT_EQ(nullptr, find(r, "pool_inner"));
+    if (TPerfCounters::available() && t->valid[TPerfEvent::instructions]) {
+        EXPECT_GT(t->values[TPerfEvent::instructions], 800000u);
+    }
+}
+#endif
+
+TEST(TPerfCounters, json_dump_lists_operations_and_events)
+{
+    TPerfCounters::instance().reset();
+    {
+        TPerfScope s("json_op");
+    }
+    std::ostringstream os;
+    TPerfCounters::instance().dump_json(os);
+    std::string j = os.str();
+    EXPECT_EQ('{', j.front());
+    EXPECT_EQ('}', j.back());
+    EXPECT_NE(std::string::npos, j.find("\"json_op\": {\"calls\": 1"));
+    for (size_t e = 0; e < TPerfEvent::COUNT; e++)
+        EXPECT_NE(std::string::npos, j.find(std::string("\"") + TPerfEvent::name(e) + "\": "));
+}
+
+TEST(TPerfCounters, reset_clears_report)
+{
+    {
+        TPerfScope s("something");
+    }
+    TPerfCounters::instance().reset();
+    EXPECT_TRUE(TPerfCounters::instance().report().empty());
+}
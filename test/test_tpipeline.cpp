@@ -0,0 +1,179 @@
+#include "tpipeline.h"
+
+#include <sstream>
+
+#include <gtest.h>
+
+namespace
+{
+    TDynamicMatrix<int> filled(size_t n)
+    {
+        TDynamicMatrix<int> m(n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                m[i][j] = int(i * 3 + j) % 11 - 5;
+        return m;
+    }
+
+    std::string text(const TDynamicMatrix<int>& m)
+    {
+        std::ostringstream os;
+        os << m;
+        return os.str();
+    }
+
+    TGenerator<int> counter(int n)
+    {
+        for (int i = 0; i < n; i++)
+            co_yield i;
+    }
+
+    TGenerator<int> failing(int after)
+    {
+        for (int i = 0; i < after; i++)
+            co_yield i;
+        throw std::runtime_error("source failed");
+    }
+}
+
+TEST(TGenerator, yields_values_in_order)
+{
+    std::vector<int> got;
+    for (int v : counter(5))
+        got.push_back(v);
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2, 3, 4 }), got);
+}
+
+TEST(TGenerator, empty_sequence)
+{
+    TGenerator<int> g = counter(0);
+    EXPECT_FALSE(g.next());
+    EXPECT_FALSE(g.next());
+}
+
+TEST(TGenerator, exception_is_thrown_from_next)
+{
+    TGenerator<int> g = failing(2);
+    EXPECT_TRUE(g.next());
+    EXPECT_TRUE(g.next());
+    EXPECT_THROW(g.next(), std::runtime_error);
+}
+
+TEST(TPipeline, read_splits_into_row_blocks)
+{
+    TDynamicMatrix<int> m = filled(7);
+    std::istringstream in(text(m));
+    std::vector<size_t> firsts, sizes;
+    for (TRowBlock<int>& b : TPipeline::read<int>(in, 7, 3)) {
+        firsts.push_back(b.first);
+        sizes.push_back(b.rows.size());
+        for (size_t r = 0; r < b.rows.size(); r++)
+            EXPECT_EQ(m[b.first + r], b.rows[r]);
+    }
+    EXPECT_EQ((std::vector<size_t>{ 0, 3, 6 }), firsts);
+    EXPECT_EQ((std::vector<size_t>{ 3, 3, 1 }), sizes);
+}
+
+TEST(TPipeline, read_and_write_round_trip)
+{
+    TDynamicMatrix<int> m = filled(9);
+    std::istringstream in(text(m));
+    std::ostringstream out;
+    EXPECT_EQ(9u, TPipeline::write(TPipeline::read<int>(in, 9, 4), out));
+    EXPECT_EQ(text(m), out.str());
+}
+
+TEST(TPipeline, truncated_input_throws)
+{
+    std::istringstream in("1 2 3\n4 5");
+    std::ostringstream out;
+    EXPECT_THROW(TPipeline::write(TPipeline::read<int>(in, 3, 1), out), std::runtime_error);
+}
+
+TEST(TPipeline, zero_block_rows_throws)
+{
+    std::istringstream in("1");
+    TGenerator<TRowBlock<int>> g = TPipeline::read<int>(in, 1, 0);
+    EXPECT_THROW(g.next(), std::invalid_argument);
+}
+
+TEST(TPipeline, gemv_matches_matrix_vector_product)
+{
+    const size_t n = 25;
+    TDynamicMatrix<int> m = filled(n);
+    TDynamicVector<int> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = int(i % 4) - 1;
+    std::istringstream in(text(m));
+    TDynamicVector<int> y(n);
+    TPipeline::collect(TPipeline::gemv(TPipeline::prefetch(TPipeline::read<int>(in, n, 4), 2), x), y);
+    EXPECT_EQ(m * x, y);
+}
+
+TEST(TPipeline, map_and_scale_stages)
+{
+    const size_t n = 6;
+    TDynamicMatrix<int> m = filled(n);
+    std::istringstream in(text(m));
+    std::ostringstream out;
+    TPipeline::write(TPipeline::scale(TPipeline::map(TPipeline::read<int>(in, n, 2),
+        [](int v) { return v * v; }), 3), out);
+    TDynamicMatrix<int> expect(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            expect[i][j] = 3 * m[i][j] * m[i][j];
+    EXPECT_EQ(text(expect), out.str());
+}
+
+TEST(TPipeline, prefetch_keeps_order)
+{
+    std::vector<int> got;
+    for (int v : TPipeline::prefetch(counter(50), 4))
+        got.push_back(v);
+    ASSERT_EQ(50u, got.size());
+    for (int i = 0; i < 50; i++)
+        EXPECT_EQ(i, got[i]);
+}
+
+TEST(TPipeline, prefetch_is_bounded)
+{
+    // источник считает запрошенные значения; потребитель стоит после первого
+    std::shared_ptr<std::atomic<int>> pulled = std::make_shared<std::atomic<int>>(0);
+    auto src = [](std::shared_ptr<std::atomic<int>> p) -> TGenerator<int> {
+        for (int i = 0; i < 100; i++) {
+            p->fetch_add(1);
+            co_yield i;
+        }
+    };
+    TGenerator<int> g = TPipeline::prefetch(src(pulled), 3);
+    ASSERT_TRUE(g.next());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    while (TThreadPool::instance().run_pending())
+        ;
+    EXPECT_LE(pulled->load(), 4);
+}
+
+TEST(TPipeline, prefetch_passes_source_error)
+{
+    TGenerator<int> g = TPipeline::prefetch(failing(3), 2);
+    int cnt = 0;
+    EXPECT_THROW({ while (g.next()) cnt++; }, std::runtime_error);
+    EXPECT_EQ(3, cnt);
+}
+
+TEST(TPipeline, abandoned_prefetch_stops_reading)
+{
+    const size_t n = 40;
+    TDynamicMatrix<int> m = filled(n);
+    auto in = std::make_unique<std::istringstream>(text(m));
+    {
+        TGenerator<TRowBlock<int>> g = TPipeline::prefetch(TPipeline::read<int>(*in, n, 2), 4);
+        ASSERT_TRUE(g.next());
+        EXPECT_EQ(0u, g.value().first);
+    }
+    // после разрушения конвейера поток больше не используется
+    in.reset();
+    while (TThreadPool::instance().run_pending())
+        ;
+}
+
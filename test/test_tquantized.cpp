@@ -0,0 +1,70 @@
+#include "tquantized.h"
+
+#include <gtest.h>
+
+namespace
+{
+TDynamicMatrix<float> sample(size_t n, int seed)
+{
+    TDynamicMatrix<float> m(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            m[i][j] = (float)((int)((i * 31 + j * 17 + seed) % 41) - 15) * 0.1f;
+    return m;
+}
+}
+
+TEST(TQuantizedMatrix, cant_create_with_bad_parameters)
+{
+    ASSERT_ANY_THROW(TQuantizedMatrix m(0));
+    ASSERT_ANY_THROW(TQuantizedMatrix m(3, -1.0f));
+    ASSERT_ANY_THROW(TQuantizedMatrix m(3, 1.0f, 200));
+}
+
+TEST(TQuantizedMatrix, quantize_round_trip_error_is_within_half_step)
+{
+    TDynamicMatrix<float> m = sample(9, 1);
+    for (bool symmetric : { false, true }) {
+        TQuantizedMatrix q = TQuantizedMatrix::quantize(m, symmetric);
+        TDynamicMatrix<float> back = q.dequantize();
+        for (size_t i = 0; i < 9; i++)
+            for (size_t j = 0; j < 9; j++)
+                EXPECT_NEAR(m[i][j], back[i][j], q.scale() * 0.5f + 1e-6f);
+    }
+}
+
+TEST(TQuantizedMatrix, int32_product_is_exact)
+{
+    const size_t n = 45;
+    TQuantizedMatrix a(n, 0.5f, 3), b(n, 0.25f, -7);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            a(i, j) = (int8_t)((int)((i * 7 + j * 13) % 256) - 128);
+            b(i, j) = (int8_t)((int)((i * 11 + j * 5) % 256) - 128);
+        }
+    TDynamicMatrix<int32_t> c = TQuantizedMatrix::multiply_s32(a, b);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            int32_t s = 0;
+            for (size_t k = 0; k < n; k++)
+                s += ((int32_t)a(i, k) - 3) * ((int32_t)b(k, j) + 7);
+            EXPECT_EQ(s, c[i][j]);
+        }
+}
+
+TEST(TQuantizedMatrix, float_product_approximates_exact_product)
+{
+    const size_t n = 33;
+    TDynamicMatrix<float> a = sample(n, 2), b = sample(n, 5);
+    TDynamicMatrix<float> exact = a * b;
+    TDynamicMatrix<float> approx = TQuantizedMatrix::quantize(a) * TQuantizedMatrix::quantize(b);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            EXPECT_NEAR(exact[i][j], approx[i][j], 0.5f);
+}
+
+TEST(TQuantizedMatrix, cant_multiply_matrices_with_not_equal_size)
+{
+    TQuantizedMatrix a(3), b(4);
+    EXPECT_THROW(a * b, std::invalid_argument);
+}
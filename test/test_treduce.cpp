@@ -0,0 +1,88 @@
+#include "treduce.h"
+
+#include <gtest.h>
+
+TEST(TReduce, can_compute_sum_and_norms)
+{
+    double arr[] = { 3.0, -4.0, 1.0, -2.0, 0.5, 6.0, -1.5, 2.0, 1.0, -3.0 };
+    TDynamicVector<double> v(arr, 10);
+    EXPECT_DOUBLE_EQ(3.0, TReduce<double>::sum(v));
+    EXPECT_DOUBLE_EQ(24.0, TReduce<double>::l1(v));
+    EXPECT_DOUBLE_EQ(std::sqrt(v * v), TReduce<double>::l2(v));
+    EXPECT_DOUBLE_EQ(6.0, TReduce<double>::max_abs(v));
+}
+
+TEST(TReduce, can_find_min_and_max)
+{
+    int arr[] = { 4, -7, 9, 9, -7, 0 };
+    TDynamicVector<int> v(arr, 6);
+    EXPECT_EQ(-7, TReduce<int>::min(v));
+    EXPECT_EQ(9, TReduce<int>::max(v));
+    EXPECT_EQ(1, TReduce<int>::argmin(v));
+    EXPECT_EQ(2, TReduce<int>::argmax(v));
+}
+
+TEST(TReduce, l2_norm_does_not_overflow)
+{
+    TDynamicVector<double> v(20);
+    for (size_t i = 0; i < 20; i++)
+        v[i] = 1e200;
+    EXPECT_NEAR(1e200 * std::sqrt(20.0), TReduce<double>::l2(v), 1e188);
+}
+
+TEST(TReduce, l2_norm_does_not_underflow)
+{
+    TDynamicVector<float> v(3);
+    v[0] = 3e-30f;
+    v[1] = 4e-30f;
+    EXPECT_NEAR(5e-30f, TReduce<float>::l2(v), 1e-35f);
+}
+
+TEST(TReduce, l2_norm_of_integer_vector_is_double)
+{
+    int arr[] = { 3, 4 };
+    TDynamicVector<int> v(arr, 2);
+    EXPECT_DOUBLE_EQ(5.0, TReduce<int>::l2(v));
+}
+
+TEST(TReduce, fused_stats_match_separate_reductions)
+{
+    TDynamicVector<double> v(37);
+    for (size_t i = 0; i < 37; i++)
+        v[i] = (double)((i * 11) % 13) - 6.5;
+    TVectorStats<double> s = TReduce<double>::stats(v);
+    EXPECT_DOUBLE_EQ(TReduce<double>::sum(v), s.sum);
+    EXPECT_DOUBLE_EQ(TReduce<double>::l1(v), s.l1);
+    EXPECT_NEAR(TReduce<double>::l2(v), s.l2, 1e-12);
+    EXPECT_EQ(TReduce<double>::max_abs(v), s.max_abs);
+    EXPECT_EQ(TReduce<double>::min(v), s.min);
+    EXPECT_EQ(TReduce<double>::max(v), s.max);
+    EXPECT_EQ(TReduce<double>::argmin(v), s.argmin);
+    EXPECT_EQ(TReduce<double>::argmax(v), s.argmax);
+}
+
+TEST(TReduce, abs_of_smallest_integer_does_not_overflow)
+{
+    int arr[] = { std::numeric_limits<int>::min(), 1 };
+    TDynamicVector<int> v(arr, 2);
+    EXPECT_DOUBLE_EQ(-(double)std::numeric_limits<int>::min(), TReduce<int>::max_abs(v));
+    EXPECT_DOUBLE_EQ(-(double)std::numeric_limits<int>::min() + 1.0, TReduce<int>::l1(v));
+}
+
+TEST(TReduce, fused_stats_find_first_extremum_across_lanes)
+{
+    // равные экстремумы в разных дорожках и в хвосте
+    TDynamicVector<int> v(21);
+    v[3] = -5;
+    v[11] = -5;
+    v[20] = -5;
+    v[6] = 9;
+    v[14] = 9;
+    TVectorStats<int> s = TReduce<int>::stats(v);
+    EXPECT_EQ(-5, s.min);
+    EXPECT_EQ(3u, s.argmin);
+    EXPECT_EQ(9, s.max);
+    EXPECT_EQ(6u, s.argmax);
+    EXPECT_EQ(TReduce<int>::sum(v), s.sum);
+    EXPECT_EQ(TReduce<int>::l1(v), s.l1);
+}
@@ -0,0 +1,131 @@
+#include "tsemiring.h"
+
+#include <gtest.h>
+
+namespace
+{
+const double INF = std::numeric_limits<double>::infinity();
+
+// кратчайшие пути Флойдом-Уоршеллом для сравнения
+TDynamicMatrix<double> floyd(TDynamicMatrix<double> d)
+{
+    size_t n = d.size();
+    for (size_t i = 0; i < n; i++)
+        d[i][i] = std::min(d[i][i], 0.0);
+    for (size_t k = 0; k < n; k++)
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+                d[i][j] = std::min(d[i][j], d[i][k] + d[k][j]);
+    return d;
+}
+}
+
+TEST(TSemiring, min_plus_product_of_small_matrices)
+{
+    TDynamicMatrix<double> a(2), b(2);
+    a[0][0] = 1; a[0][1] = 5;
+    a[1][0] = INF; a[1][1] = 2;
+    b[0][0] = 0; b[0][1] = 3;
+    b[1][0] = 1; b[1][1] = INF;
+    TDynamicMatrix<double> c = semiring_product<TMinPlus<double>>(a, b);
+    EXPECT_EQ(1, c[0][0]);
+    EXPECT_EQ(4, c[0][1]);
+    EXPECT_EQ(3, c[1][0]);
+    EXPECT_EQ(INF, c[1][1]);
+}
+
+TEST(TSemiring, max_plus_product_of_small_matrices)
+{
+    TDynamicMatrix<int> a(2), b(2);
+    a[0][0] = 1; a[0][1] = 5;
+    a[1][0] = 0; a[1][1] = 2;
+    b[0][0] = 0; b[0][1] = 3;
+    b[1][0] = 1; b[1][1] = -4;
+    TDynamicMatrix<int> c = semiring_product<TMaxPlus<int>>(a, b);
+    EXPECT_EQ(6, c[0][0]);
+    EXPECT_EQ(4, c[0][1]);
+    EXPECT_EQ(3, c[1][0]);
+    EXPECT_EQ(3, c[1][1]);
+}
+
+TEST(TSemiring, plus_times_product_matches_operator)
+{
+    const size_t n = 37;
+    TDynamicMatrix<long> a(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            a[i][j] = (long)((i * 7 + j) % 11) - 5;
+            b[i][j] = (long)((i + j * 3) % 13) - 6;
+        }
+    EXPECT_EQ(a * b, semiring_product<TPlusTimes<long>>(a, b));
+}
+
+TEST(TSemiring, throws_when_sizes_differ)
+{
+    TDynamicMatrix<int> a(2), b(3);
+    ASSERT_ANY_THROW(semiring_product<TMinPlus<int>>(a, b));
+}
+
+TEST(TSemiring, min_plus_closure_gives_shortest_paths)
+{
+    const size_t n = 150;
+    TDynamicMatrix<double> g(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+            g[i][j] = (i * 13 + j * 7) % 5 == 0 ? double((i + 3 * j) % 17 + 1) : INF;
+    EXPECT_EQ(floyd(g), semiring_closure<TMinPlus<double>>(g));
+}
+
+TEST(TSemiring, min_plus_closure_does_not_overflow_for_integers)
+{
+    TDynamicMatrix<int> g(3);
+    const int inf = TMinPlus<int>::zero();
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            g[i][j] = inf;
+    g[0][1] = 4;
+    g[1][2] = 5;
+    TDynamicMatrix<int> d = semiring_closure<TMinPlus<int>>(g);
+    EXPECT_EQ(9, d[0][2]);
+    EXPECT_EQ(0, d[1][1]);
+    EXPECT_EQ(inf, d[2][0]);
+}
+
+TEST(TSemiring, unreachable_stays_unreachable_with_negative_weights)
+{
+    const int inf = TMinPlus<int>::zero();
+    EXPECT_EQ(inf, TMinPlus<int>::mul(inf, -7));
+    EXPECT_EQ(inf, TMinPlus<int>::mul(-7, inf));
+    EXPECT_EQ(TMaxPlus<int>::zero(), TMaxPlus<int>::mul(TMaxPlus<int>::zero(), 7));
+    EXPECT_EQ(std::numeric_limits<int>::lowest(), TMinPlus<int>::mul(std::numeric_limits<int>::lowest(), -1));
+    EXPECT_EQ(std::numeric_limits<int>::max(), TMaxPlus<int>::mul(std::numeric_limits<int>::max(), 1));
+    // 0 -> 1 с весом -3, вершина 2 недостижима из 0 и 1
+    TDynamicMatrix<int> g(3);
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            g[i][j] = inf;
+    g[0][1] = -3;
+    g[2][1] = -2;
+    TDynamicMatrix<int> d = semiring_closure<TMinPlus<int>>(g);
+    EXPECT_EQ(-3, d[0][1]);
+    EXPECT_EQ(inf, d[0][2]);
+    EXPECT_EQ(inf, d[1][2]);
+    EXPECT_EQ(inf, d[1][0]);
+}
+
+TEST(TSemiring, or_and_closure_gives_reachability)
+{
+    const size_t n = 10;
+    TDynamicMatrix<int> g(n);
+    for (size_t i = 0; i + 1 < 5; i++)
+        g[i][i + 1] = 1;       // цепочка 0 -> 1 -> ... -> 4
+    g[7][5] = 1;
+    TDynamicMatrix<int> r = semiring_closure<TOrAnd<int>>(g);
+    for (size_t i = 0; i < 5; i++)
+        for (size_t j = 0; j < 5; j++)
+            EXPECT_EQ(i <= j ? 1 : 0, r[i][j]);
+    EXPECT_EQ(1, r[7][5]);
+    EXPECT_EQ(0, r[5][7]);
+    EXPECT_EQ(0, r[0][7]);
+    EXPECT_EQ(1, r[9][9]);
+}
@@ -0,0 +1,61 @@
+#include "tstaticmatrix.h"
+
+#include <gtest.h>
+
+TEST(TStaticVector, operations_are_constexpr)
+{
+    constexpr TStaticVector<int, 3> a{ 1, 2, 3 };
+    constexpr TStaticVector<int, 3> b{ 4, 5, 6 };
+    static_assert(a * b == 32, "dot product");
+    static_assert((a + b)[2] == 9, "sum");
+    static_assert((b - a) == TStaticVector<int, 3>{ 3, 3, 3 }, "difference");
+    static_assert((a * 2)[1] == 4, "scalar product");
+    EXPECT_EQ(3u, a.size());
+}
+
+TEST(TStaticVector, throws_when_index_is_too_large)
+{
+    TStaticVector<int, 4> v;
+    EXPECT_THROW(v[4] = 1, std::out_of_range);
+}
+
+TEST(TStaticVector, converts_to_and_from_dynamic_vector)
+{
+    TStaticVector<double, 4> s{ 1.0, 2.0, 3.0, 4.0 };
+    TDynamicVector<double> d = s;
+    EXPECT_EQ(4, d.size());
+    EXPECT_EQ(3.0, d[2]);
+    EXPECT_EQ(s, (TStaticVector<double, 4>(d)));
+    EXPECT_THROW((TStaticVector<double, 3>(d)), std::invalid_argument);
+}
+
+TEST(TStaticMatrix, operations_are_constexpr)
+{
+    constexpr TStaticMatrix<int, 2> a{ { 1, 2 }, { 3, 4 } };
+    constexpr TStaticMatrix<int, 2> b{ { 5, 6 }, { 7, 8 } };
+    constexpr TStaticMatrix<int, 2> c = a * b;
+    static_assert(c[0][0] == 19 && c[0][1] == 22 && c[1][0] == 43 && c[1][1] == 50, "product");
+    static_assert((a + b)[1][1] == 12, "sum");
+    static_assert((a * TStaticVector<int, 2>{ 1, 1 })[1] == 7, "matrix-vector product");
+    EXPECT_EQ(2u, c.size());
+}
+
+TEST(TStaticMatrix, product_matches_dynamic_matrix)
+{
+    TStaticMatrix<double, 6> a, b;
+    for (size_t i = 0; i < 6; i++)
+        for (size_t j = 0; j < 6; j++) {
+            a[i][j] = (double)(i + 2 * j);
+            b[i][j] = (double)(i * j) - 3.0;
+        }
+    TDynamicMatrix<double> da = a, db = b;
+    EXPECT_EQ(da * db, (a * b).to_dynamic());
+    EXPECT_EQ(da - db, (a - b).to_dynamic());
+    EXPECT_EQ(a, (TStaticMatrix<double, 6>(da)));
+}
+
+TEST(TStaticMatrix, cant_create_from_dynamic_matrix_of_other_size)
+{
+    TDynamicMatrix<int> m(3);
+    EXPECT_THROW((TStaticMatrix<int, 4>(m)), std::invalid_argument);
+}
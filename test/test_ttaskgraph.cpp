@@ -0,0 +1,157 @@
+#include "ttaskgraph.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <gtest.h>
+
+namespace
+{
+    // исполнитель с фоновыми потоками даже на одном ядре
+    TTaskExecutor& executor()
+    {
+        static TTaskExecutor ex(3);
+        return ex;
+    }
+}
+
+TEST(TTaskGraph, empty_graph_runs)
+{
+    TTaskGraph g;
+    EXPECT_NO_THROW(g.run(executor()));
+}
+
+TEST(TTaskGraph, builds_raw_war_waw_dependencies)
+{
+    TTaskGraph g;
+    uint64_t x = TTaskGraph::tile(0, 0, 0), y = TTaskGraph::tile(0, 0, 1);
+    size_t w1 = g.add([]() {}, {}, { x });
+    size_t r1 = g.add([]() {}, { x }, { y });
+    size_t r2 = g.add([]() {}, { x }, {});
+    size_t w2 = g.add([]() {}, { y }, { x });
+    size_t w3 = g.add([]() {}, {}, { y });
+    EXPECT_EQ(0u, g.dependencies(w1));
+    EXPECT_EQ(1u, g.dependencies(r1));     // RAW x
+    EXPECT_EQ(1u, g.dependencies(r2));     // RAW x
+    EXPECT_EQ(3u, g.dependencies(w2));     // RAW y, WAW и WAR x
+    EXPECT_EQ(2u, g.dependencies(w3));     // WAW y, WAR y
+}
+
+TEST(TTaskGraph, duplicate_edges_are_merged)
+{
+    TTaskGraph g;
+    uint64_t x = TTaskGraph::tile(0, 0, 0), y = TTaskGraph::tile(1, 0, 0);
+    g.add([]() {}, {}, { x, y });
+    size_t t = g.add([]() {}, { x, y }, {});
+    EXPECT_EQ(1u, g.dependencies(t));
+}
+
+TEST(TTaskGraph, order_follows_dependencies)
+{
+    // цепочки по ключам: в каждой порядок выполнения совпадает с порядком добавления
+    const size_t chains = 8, len = 50;
+    std::vector<std::vector<size_t>> seen(chains);
+    std::mutex mtx;
+    TTaskGraph g;
+    for (size_t s = 0; s < len; s++)
+        for (size_t c = 0; c < chains; c++)
+            g.add([&, c, s]() {
+                std::lock_guard<std::mutex> lk(mtx);
+                seen[c].push_back(s);
+            }, {}, { TTaskGraph::tile(0, c, 0) });
+    g.run(executor());
+    for (size_t c = 0; c < chains; c++) {
+        ASSERT_EQ(len, seen[c].size());
+        for (size_t s = 0; s < len; s++)
+            EXPECT_EQ(s, seen[c][s]);
+    }
+}
+
+TEST(TTaskGraph, readers_run_between_writers)
+{
+    std::atomic<int> value(0), ok(0);
+    uint64_t x = TTaskGraph::tile(0, 0, 0);
+    TTaskGraph g;
+    g.add([&]() { value = 1; }, {}, { x });
+    for (int i = 0; i < 20; i++)
+        g.add([&]() { if (value == 1) ok++; }, { x }, {});
+    g.add([&]() { value = 2; }, {}, { x });
+    g.run(executor());
+    EXPECT_EQ(20, ok.load());
+    EXPECT_EQ(2, value.load());
+}
+
+TEST(TTaskGraph, independent_tasks_all_run)
+{
+    std::atomic<int> cnt(0);
+    TTaskGraph g;
+    for (size_t i = 0; i < 1000; i++)
+        g.add([&]() { cnt++; }, {}, { TTaskGraph::tile(0, i, 0) });
+    g.run(executor());
+    EXPECT_EQ(1000, cnt.load());
+    // повторный запуск того же графа
+    g.run(executor());
+    EXPECT_EQ(2000, cnt.load());
+}
+
+TEST(TTaskGraph, exception_stops_graph_and_is_rethrown)
+{
+    std::atomic<int> after(0);
+    uint64_t x = TTaskGraph::tile(0, 0, 0);
+    TTaskGraph g;
+    g.add([]() { throw std::runtime_error("task failed"); }, {}, { x });
+    for (int i = 0; i < 10; i++)
+        g.add([&]() { after++; }, { x }, {});
+    EXPECT_THROW(g.run(executor()), std::runtime_error);
+    EXPECT_EQ(0, after.load());
+    // исполнитель остается рабочим
+    TTaskGraph h;
+    h.add([&]() { after++; }, {}, {});
+    h.run(executor());
+    EXPECT_EQ(1, after.load());
+}
+
+TEST(TTaskGraph, nested_run_is_rejected)
+{
+    TTaskGraph g;
+    bool rejected = false;
+    g.add([&]() {
+        TTaskGraph inner;
+        try {
+            inner.run(executor());
+        }
+        catch (const std::logic_error&) {
+            rejected = true;
+        }
+    }, {}, {});
+    g.run(executor());
+    EXPECT_TRUE(rejected);
+}
+
+TEST(TTaskGraph, default_executor_runs_graph)
+{
+    std::atomic<int> cnt(0);
+    TTaskGraph g;
+    for (size_t i = 0; i < 10; i++)
+        g.add([&]() { cnt++; }, {}, {});
+    g.run();
+    EXPECT_EQ(10, cnt.load());
+}
+
+TEST(TTaskGraph, tiny_graphs_back_to_back)
+{
+    // потоки, проснувшиеся поздно, не должны брать задачи следующего запуска
+    static TTaskExecutor ex(8);
+    std::atomic<int> cnt(0);
+    int expected = 0;
+    for (int it = 0; it < 3000; it++) {
+        TTaskGraph g;
+        int tasks = 1 + it % 3;
+        for (int i = 0; i < tasks; i++)
+            g.add([&]() { cnt++; }, {}, { TTaskGraph::tile(0, i, 0) });
+        g.run(ex);
+        expected += tasks;
+        ASSERT_EQ(expected, cnt.load());
+    }
+}
@@ -0,0 +1,125 @@
+#include "ttiledalgebra.h"
+#include "tcompare.h"
+
+#include <gtest.h>
+
+namespace
+{
+    TTaskExecutor& executor()
+    {
+        static TTaskExecutor ex(3);
+        return ex;
+    }
+
+    TDynamicMatrix<double> random_matrix(size_t n, unsigned seed)
+    {
+        TDynamicMatrix<double> m(n);
+        unsigned s = seed;
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++) {
+                s = s * 1103515245u + 12345u;
+                m[i][j] = double((s >> 16) % 1000) / 500.0 - 1.0;
+            }
+        return m;
+    }
+
+    // M M^T + n E - симметричная положительно определенная
+    TDynamicMatrix<double> spd(size_t n, unsigned seed)
+    {
+        TDynamicMatrix<double> m = random_matrix(n, seed), r(n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++) {
+                double s = 0;
+                for (size_t k = 0; k < n; k++)
+                    s += m[i][k] * m[j][k];
+                r[i][j] = s + (i == j ? double(n) : 0.0);
+            }
+        return r;
+    }
+
+    TDynamicMatrix<double> transpose(const TDynamicMatrix<double>& m)
+    {
+        TDynamicMatrix<double> t(m.size());
+        for (size_t i = 0; i < m.size(); i++)
+            for (size_t j = 0; j < m.size(); j++)
+                t[j][i] = m[i][j];
+        return t;
+    }
+}
+
+TEST(TTiledAlgebra, cholesky_reconstructs_matrix)
+{
+    for (size_t n : { 1, 7, 30, 65 }) {
+        TDynamicMatrix<double> a = spd(n, unsigned(n)), l(a);
+        TTiledAlgebra<double>::cholesky(l, 8, executor());
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = i + 1; j < n; j++)
+                EXPECT_EQ(0.0, l[i][j]);
+        EXPECT_TRUE(all_close(l * transpose(l), a, 1e-9, 1e-9));
+    }
+}
+
+TEST(TTiledAlgebra, cholesky_tile_larger_than_matrix)
+{
+    TDynamicMatrix<double> a = spd(10, 3), l(a);
+    TTiledAlgebra<double>::cholesky(l, 64, executor());
+    EXPECT_TRUE(all_close(l * transpose(l), a, 1e-9, 1e-9));
+}
+
+TEST(TTiledAlgebra, cholesky_rejects_indefinite_matrix)
+{
+    TDynamicMatrix<double> a = spd(20, 5);
+    a[15][15] = -100.0;
+    EXPECT_THROW(TTiledAlgebra<double>::cholesky(a, 4, executor()), std::invalid_argument);
+}
+
+TEST(TTiledAlgebra, lu_reconstructs_matrix)
+{
+    for (size_t n : { 1, 9, 33 }) {
+        TDynamicMatrix<double> a = random_matrix(n, unsigned(n) + 7);
+        for (size_t i = 0; i < n; i++)
+            a[i][i] += double(n);
+        TDynamicMatrix<double> f(a);
+        TTiledAlgebra<double>::lu(f, 5, executor());
+        TDynamicMatrix<double> l(n), u(n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++) {
+                l[i][j] = i > j ? f[i][j] : (i == j ? 1.0 : 0.0);
+                u[i][j] = i <= j ? f[i][j] : 0.0;
+            }
+        EXPECT_TRUE(all_close(l * u, a, 1e-9, 1e-9));
+    }
+}
+
+TEST(TTiledAlgebra, lu_rejects_zero_pivot)
+{
+    TDynamicMatrix<double> a(4);
+    a[0][1] = a[1][0] = a[2][2] = a[3][3] = 1.0;
+    EXPECT_THROW(TTiledAlgebra<double>::lu(a, 2, executor()), std::invalid_argument);
+}
+
+TEST(TTiledAlgebra, multiply_matches_gemm)
+{
+    for (size_t n : { 1, 16, 37 }) {
+        TDynamicMatrix<double> a = random_matrix(n, 1), b = random_matrix(n, 2), c(n);
+        TTiledAlgebra<double>::multiply(a, b, c, 8, executor());
+        EXPECT_TRUE(all_close(c, a * b, 1e-12, 1e-12));
+    }
+}
+
+TEST(TTiledAlgebra, multiply_checks_arguments)
+{
+    TDynamicMatrix<double> a(4), b(5), c(4);
+    EXPECT_THROW(TTiledAlgebra<double>::multiply(a, b, c, 2, executor()), std::invalid_argument);
+    EXPECT_THROW(TTiledAlgebra<double>::multiply(a, c, a, 2, executor()), std::invalid_argument);
+    TDynamicMatrix<double> d(4);
+    EXPECT_THROW(TTiledAlgebra<double>::multiply(a, c, d, 0, executor()), std::invalid_argument);
+    EXPECT_THROW(TTiledAlgebra<double>::lu(d, 0, executor()), std::invalid_argument);
+}
+
+TEST(TTiledAlgebra, default_executor)
+{
+    TDynamicMatrix<double> a = spd(24, 9), l(a);
+    TTiledAlgebra<double>::cholesky(l, 8);
+    EXPECT_TRUE(all_close(l * transpose(l), a, 1e-9, 1e-9));
+}
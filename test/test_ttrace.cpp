@@ -0,0 +1,165 @@
+#include "tmatrix.h"
+
+#include <atomic>
+#include <cstring>
+#include <sstream>
+#include <thread>
+
+#include <gtest.h>
+
+namespace
+{
+    size_t count_named(const std::vector<TTraceEvent>& ev, const char* name)
+    {
+        size_t c = 0;
+        for (const TTraceEvent& e : ev)
+            if (std::strcmp(e.name, name) == 0)
+                c++;
+        return c;
+    }
+
+    // включает сбор на время теста и очищает буферы
+    struct TTraceOn
+    {
+        TTraceOn() { TTrace::clear(); TTrace::enable(); }
+        ~TTraceOn() { TTrace::enable(false); TTrace::clear(); }
+    };
+}
+
+TEST(TTrace, disabled_by_default_records_nothing)
+{
+    TTrace::clear();
+    ASSERT_FALSE(TTrace::enabled());
+    {
+        TTraceScope s("idle");
+    }
+    EXPECT_EQ(0u, count_named(TTrace::events(), "idle"));
+}
+
+TEST(TTrace, scope_records_interval_when_enabled)
+{
+    TTraceOn on;
+    uint64_t before = TTrace::now();
+    {
+        TTraceScope s("span");
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    uint64_t after = TTrace::now();
+    std::vector<TTraceEvent> ev = TTrace::events();
+    ASSERT_EQ(1u, ev.size());
+    EXPECT_STREQ("span", ev[0].name);
+    EXPECT_GE(ev[0].start, before);
+    EXPECT_GE(ev[0].duration, 1000000u);
+    EXPECT_LE(ev[0].start + ev[0].duration, after);
+}
+
+TEST(TTrace, events_are_sorted_by_start)
+{
+    TTraceOn on;
+    TTrace::record("b", 20, 30);
+    TTrace::record("a", 10, 40);
+    std::vector<TTraceEvent> ev = TTrace::events();
+    ASSERT_EQ(2u, ev.size());
+    EXPECT_STREQ("a", ev[0].name);
+    EXPECT_STREQ("b", ev[1].name);
+    EXPECT_EQ(30u, ev[0].duration);
+}
+
+TEST(TTrace, threads_get_distinct_ids)
+{
+    TTraceOn on;
+    TTrace::record("main", 1, 2);
+    std::thread t([]() { TTrace::record("other", 3, 4); });
+    t.join();
+    std::vector<TTraceEvent> ev = TTrace::events();
+    ASSERT_EQ(2u, ev.size());
+    EXPECT_NE(ev[0].tid, ev[1].tid);
+}
+
+TEST(TTrace, ring_keeps_last_events)
+{
+    TTraceOn on;
+    const uint64_t n = TTrace::RING + 100;
+    for (uint64_t i = 0; i < n; i++)
+        TTrace::record("e", i, i + 1);
+    std::vector<TTraceEvent> ev = TTrace::events();
+    ASSERT_EQ(TTrace::RING - 1, ev.size());
+    EXPECT_EQ(101u, ev.front().start);
+    EXPECT_EQ(n - 1, ev.back().start);
+}
+
+TEST(TTrace, concurrent_reads_see_whole_intervals)
+{
+    TTraceOn on;
+    std::atomic<bool> done(false);
+    // у каждого интервала длительность равна началу: смесь двух записей видна сразу
+    std::thread w([&done]() {
+        for (uint64_t i = 1; !done.load(); i++)
+            TTrace::record("w", i, 2 * i);
+    });
+    for (int k = 0; k < 200; k++)
+        for (const TTraceEvent& e : TTrace::events())
+            if (std::strcmp(e.name, "w") == 0) {
+                ASSERT_EQ(e.start, e.duration);
+            }
+    done = true;
+    w.join();
+}
+
+TEST(TTrace, clear_drops_events)
+{
+    TTraceOn on;
+    TTrace::record("x", 0, 1);
+    TTrace::clear();
+    EXPECT_TRUE(TTrace::events().empty());
+}
+
+TEST(TTrace, dump_json_writes_complete_events)
+{
+    TTraceOn on;
+    TTrace::record("gemm", 1500, 4250);
+    std::ostringstream os;
+    TTrace::dump_json(os);
+    std::string s = os.str();
+    EXPECT_NE(std::string::npos, s.find("\"traceEvents\""));
+    EXPECT_NE(std::string::npos, s.find("\"name\": \"gemm\""));
+    EXPECT_NE(std::string::npos, s.find("\"ph\": \"X\""));
+    EXPECT_NE(std::string::npos, s.find("\"ts\": 1.500"));
+    EXPECT_NE(std::string::npos, s.find("\"dur\": 2.750"));
+}
+
+TEST(TTrace, empty_dump_is_valid_json)
+{
+    TTrace::clear();
+    std::ostringstream os;
+    TTrace::dump_json(os);
+    EXPECT_EQ("{\"traceEvents\": [\n], \"displayTimeUnit\": \"ns\"}\n", os.str());
+}
+
+#if defined(TMATRIX_ENABLE_TRACE)
+TEST(TTrace, kernels_and_pool_are_traced)
+{
+    TExecMode old = TParallelConfig::mode();
+    TParallelConfig::mode() = TExecMode::parallel;
+    const size_t n = 200;
+    TDynamicMatrix<double> a(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++) {
+            a[i][j] = double(i + j);
+            b[i][j] = double(i) - double(j);
+        }
+    {
+        TTraceOn on;
+        TDynamicMatrix<double> c = a + b;
+        TDynamicMatrix<double> d = a * b;
+        std::vector<TTraceEvent> ev = TTrace::events();
+        EXPECT_EQ(1u, count_named(ev, "matrix_add"));
+        EXPECT_EQ(1u, count_named(ev, "gemm"));
+        if (TThreadPool::instance().threads() > 0) {
+            EXPECT_GT(count_named(ev, "parallel_for"), 0u);
+            EXPECT_GT(count_named(ev, "task"), 0u);
+        }
+    }
+    TParallelConfig::mode() = old;
+}
+#endif
@@ -264,3 +264,159 @@ TEST(TDynamicVector, cant_multiply_vectors_with_not_equal_size)
     EXPECT_THROW(v1 * v2, std::invalid_argument);
 }
 
+
+TEST(TDynamicVector, short_vector_uses_inline_storage)
+{
+    TDynamicVector<int> small(4);
+    TDynamicVector<int> large(TDynamicVector<int>::INLINE_CAPACITY + 1);
+    EXPECT_TRUE(small.is_inline());
+    EXPECT_FALSE(large.is_inline());
+    EXPECT_EQ(0, small[3]);
+}
+
+TEST(TDynamicVector, vector_of_vectors_does_not_use_inline_storage)
+{
+    TDynamicVector<TDynamicVector<int>> v(2);
+    EXPECT_FALSE(v.is_inline());
+}
+
+TEST(TDynamicVector, move_of_inline_vector_keeps_elements)
+{
+    int arr[] = { 1, 2, 3 };
+    TDynamicVector<int> v(arr, 3);
+    TDynamicVector<int> moved(std::move(v));
+    EXPECT_TRUE(moved.is_inline());
+    EXPECT_EQ(3, moved.size());
+    EXPECT_EQ(3, moved[2]);
+    EXPECT_EQ(0, v.size());
+}
+
+TEST(TDynamicVector, assign_switches_between_inline_and_heap_storage)
+{
+    TDynamicVector<int> small(2), large(100);
+    large[99] = 7;
+    small = large;
+    EXPECT_FALSE(small.is_inline());
+    EXPECT_EQ(7, small[99]);
+    TDynamicVector<int> tiny(1);
+    tiny[0] = 5;
+    small = tiny;
+    EXPECT_TRUE(small.is_inline());
+    EXPECT_EQ(5, small[0]);
+}
+
+TEST(TDynamicVector, swap_works_for_mixed_storage)
+{
+    TDynamicVector<int> small(2), large(50);
+    small[1] = 3;
+    large[49] = 9;
+    swap(small, large);
+    EXPECT_EQ(50, small.size());
+    EXPECT_EQ(9, small[49]);
+    EXPECT_EQ(2, large.size());
+    EXPECT_EQ(3, large[1]);
+    EXPECT_TRUE(large.is_inline());
+}
+
+TEST(TDynamicVector, parallel_operations_match_sequential_ones)
+{
+    const size_t n = 100000;
+    TDynamicVector<int> a(n), b(n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = (int)(i % 17);
+        b[i] = (int)(i % 5) - 2;
+    }
+    TParallelConfig::mode() = TExecMode::sequential;
+    TDynamicVector<int> sum = a + b, diff = a - b, scaled = a * 3;
+    int dot = a * b;
+    TParallelConfig::mode() = TExecMode::parallel;
+    EXPECT_EQ(sum, a + b);
+    EXPECT_EQ(diff, a - b);
+    EXPECT_EQ(scaled, a * 3);
+    EXPECT_EQ(a + 1, (a + 2) - 1);
+    EXPECT_EQ(dot, a * b);
+    b[n - 1] += 1;
+    EXPECT_NE(sum, a + b);
+    TParallelConfig::mode() = TExecMode::automatic;
+}
+
+TEST(TDynamicVector, large_dot_product_does_not_depend_on_mode)
+{
+    const size_t n = 300000;
+    TDynamicVector<double> a(n), b(n);
+    for (size_t i = 0; i < n; i++) {
+        a[i] = 1.0 / (double)(i + 1);
+        b[i] = (double)(i % 7) * 0.1;
+    }
+    TParallelConfig::mode() = TExecMode::sequential;
+    double seq = a * b;
+    TParallelConfig::mode() = TExecMode::parallel;
+    double par = a * b;
+    TParallelConfig::mode() = TExecMode::automatic;
+    EXPECT_EQ(seq, par);
+}
+
+TEST(TDynamicVector, bitwise_comparable_vectors_compare_by_content)
+{
+    const size_t n = 300000;
+    TDynamicVector<long long> a(n), b(n);
+    for (size_t i = 0; i < n; i++)
+        a[i] = b[i] = (long long)(i * 37);
+    for (TExecMode m : { TExecMode::sequential, TExecMode::parallel }) {
+        TParallelConfig::mode() = m;
+        EXPECT_EQ(a, b);
+        b[n - 1] = 0;
+        EXPECT_NE(a, b);
+        b[n - 1] = a[n - 1];
+    }
+    TParallelConfig::mode() = TExecMode::automatic;
+}
+
+TEST(TDynamicVector, floating_vectors_compare_by_value)
+{
+    TDynamicVector<double> a(3), b(3);
+    a[1] = 0.0;
+    b[1] = -0.0;
+    EXPECT_EQ(a, b);
+}
+
+namespace
+{
+    // счетчик живых объектов: каждый созданный элемент должен быть разрушен ровно раз
+    struct TCounted
+    {
+        static int& alive()
+        {
+            static int n = 0;
+            return n;
+        }
+        int v = 0;
+        TCounted() { alive()++; }
+        TCounted(const TCounted& c) : v(c.v) { alive()++; }
+        TCounted& operator=(const TCounted&) = default;
+        ~TCounted() { alive()--; }
+    };
+}
+
+TEST(TDynamicVector, elements_are_constructed_and_destroyed_once)
+{
+    {
+        TDynamicVector<TCounted> a(50);
+        EXPECT_EQ(50, TCounted::alive());
+        TDynamicVector<TCounted> b(a), c(10);
+        EXPECT_EQ(110, TCounted::alive());
+        c = a;
+        EXPECT_EQ(150, TCounted::alive());
+        TDynamicVector<TCounted> d(std::move(b));
+        EXPECT_EQ(150, TCounted::alive());
+    }
+    EXPECT_EQ(0, TCounted::alive());
+}
+
+TEST(TDynamicVector, large_vectors_are_page_aligned)
+{
+    TDynamicVector<double> v(100000);
+    EXPECT_EQ(0u, (uintptr_t)v.data() % TNuma::PAGE);
+    TDynamicVector<double> c(v);
+    EXPECT_EQ(0u, (uintptr_t)c.data() % TNuma::PAGE);
+}